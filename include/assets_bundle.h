@@ -0,0 +1,175 @@
+// Generated by tools/bundle_assets.py from the files in assets/. Do not edit.
+#ifndef ASSETS_BUNDLE_H
+#define ASSETS_BUNDLE_H
+
+#include <Arduino.h>
+#include <StaticBlobNode.hpp>
+
+// history.html: 1272 bytes, 656 bytes with gzip (52%)
+const char ASSET_HISTORY_HTML_HEAD[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/html; charset=UTF-8\r\n"
+  "Content-Encoding: gzip\r\n"
+  "Content-Length: 656\r\n"
+  "ETag: \"a4574fd2f70bdea4\"\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Vary: Accept-Encoding\r\n";
+const char ASSET_HISTORY_HTML_NOT_MODIFIED_HEAD[] PROGMEM =
+  "HTTP/1.1 304 Not Modified\r\n"
+  "ETag: \"a4574fd2f70bdea4\"\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Vary: Accept-Encoding\r\n";
+const uint8_t ASSET_HISTORY_HTML_BODY[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x54, 0xcd, 0x4e, 0xdb, 0x40,
+  0x10, 0xbe, 0xf3, 0x14, 0xd3, 0xd0, 0x2a, 0x4e, 0x0b, 0x71, 0x12, 0xa9, 0x55, 0xe5, 0xd8, 0xae,
+  0x0a, 0xa4, 0xa2, 0x12, 0xa8, 0x95, 0x08, 0x87, 0xde, 0x58, 0x76, 0x37, 0xf1, 0xb6, 0xf6, 0xae,
+  0xb5, 0x3b, 0x51, 0xb0, 0x10, 0x4f, 0xd0, 0x4b, 0x39, 0xf7, 0xd0, 0x53, 0x8f, 0x5c, 0xda, 0x1b,
+  0x39, 0xc2, 0x8b, 0xf8, 0x4d, 0xba, 0xfe, 0x89, 0x43, 0xa0, 0x70, 0xca, 0x78, 0xbe, 0x99, 0xf9,
+  0x76, 0xbe, 0x99, 0x89, 0xff, 0x6c, 0xef, 0xd3, 0xee, 0xf8, 0xcb, 0xe7, 0x11, 0x44, 0x98, 0xc4,
+  0xe1, 0x86, 0xbf, 0xfc, 0xe1, 0x84, 0x85, 0x1b, 0x00, 0x7e, 0xc2, 0x91, 0x00, 0x8d, 0x88, 0x36,
+  0x1c, 0x83, 0xd6, 0xf1, 0xf8, 0xc3, 0xf6, 0xdb, 0x56, 0x09, 0xa0, 0xc0, 0x98, 0x87, 0x07, 0xf9,
+  0xe2, 0x3b, 0x8d, 0xc0, 0xe4, 0x8b, 0x2b, 0x40, 0x3d, 0xcb, 0x80, 0xe6, 0xd7, 0x57, 0xa9, 0xef,
+  0x56, 0x68, 0x11, 0x67, 0x30, 0xab, 0x2c, 0x80, 0x53, 0xc5, 0x32, 0x38, 0x87, 0x89, 0x92, 0xb8,
+  0x3d, 0x21, 0x89, 0x88, 0x33, 0x0f, 0xde, 0x6b, 0x41, 0xe2, 0x21, 0x24, 0x44, 0x4f, 0x85, 0xf4,
+  0x60, 0xd0, 0x4b, 0xcf, 0x86, 0x70, 0x51, 0x86, 0x23, 0x39, 0x8d, 0xb9, 0x8d, 0x3f, 0x55, 0x9a,
+  0x71, 0xbd, 0x4d, 0x55, 0x1c, 0x93, 0xd4, 0x70, 0x0f, 0x96, 0xd6, 0x10, 0xe6, 0x82, 0x61, 0xe4,
+  0x41, 0xbf, 0xd7, 0x7b, 0xd1, 0x64, 0x45, 0x5b, 0x80, 0xac, 0x49, 0xb3, 0x60, 0x7a, 0x06, 0x46,
+  0xc5, 0x82, 0xc1, 0x26, 0xa5, 0x74, 0x08, 0x29, 0x61, 0x4c, 0xc8, 0xa9, 0x07, 0x6f, 0x2c, 0xd0,
+  0xbf, 0xcb, 0x17, 0x15, 0x59, 0x84, 0x7e, 0x9b, 0x6a, 0x35, 0x93, 0xcc, 0x83, 0x4d, 0xce, 0x79,
+  0x05, 0xfa, 0x6e, 0xdd, 0x86, 0xef, 0x56, 0xca, 0xf8, 0x45, 0x2f, 0x65, 0x7f, 0xd1, 0xe0, 0x11,
+  0x11, 0xc0, 0xc1, 0x7c, 0x71, 0x29, 0xe0, 0xf6, 0x92, 0xc0, 0xeb, 0x1e, 0xb0, 0x9b, 0x3f, 0x72,
+  0x0a, 0x49, 0xbe, 0xf8, 0x29, 0x40, 0x46, 0xf9, 0xf5, 0x6f, 0xec, 0xd8, 0x62, 0x83, 0x4a, 0xcb,
+  0xa2, 0xd3, 0x4a, 0x23, 0x1f, 0x97, 0xd2, 0x57, 0x5f, 0x7a, 0x69, 0x96, 0x50, 0xb8, 0x69, 0xa5,
+  0x8d, 0xd6, 0x5d, 0xc7, 0x86, 0xeb, 0x87, 0xde, 0x23, 0x24, 0xc8, 0x1f, 0xba, 0x47, 0xa9, 0xb2,
+  0x2f, 0x1d, 0x8b, 0xe4, 0x3f, 0xd8, 0x7d, 0xaf, 0xb5, 0x6b, 0xf6, 0xc2, 0xdb, 0xbc, 0xca, 0xc7,
+  0x72, 0x8e, 0x82, 0x05, 0xad, 0x48, 0x18, 0x54, 0x3a, 0xdb, 0xb1, 0xdf, 0xad, 0xd0, 0x06, 0x35,
+  0xa2, 0xb8, 0x4d, 0x47, 0xbe, 0xa1, 0x5a, 0xa4, 0x58, 0xa5, 0x12, 0x93, 0x49, 0x0a, 0x93, 0x99,
+  0xa4, 0x28, 0x94, 0x84, 0x58, 0x11, 0xb6, 0x5f, 0x95, 0x70, 0x3a, 0x70, 0x5e, 0xd3, 0x52, 0x25,
+  0x0d, 0x82, 0xe6, 0x06, 0x02, 0x20, 0x73, 0x22, 0x10, 0x26, 0x1c, 0x69, 0xe4, 0xb4, 0x5d, 0x92,
+  0x0a, 0xb7, 0xa6, 0x6c, 0x77, 0x86, 0x6b, 0xe1, 0x44, 0xeb, 0x26, 0xdc, 0xa6, 0x76, 0xbf, 0x1a,
+  0x25, 0x9d, 0x7b, 0x31, 0xe5, 0xb3, 0x03, 0x60, 0x8a, 0xce, 0x12, 0x2e, 0xb1, 0x3b, 0xe5, 0x38,
+  0x8a, 0x79, 0x61, 0xee, 0x64, 0x1f, 0x99, 0xd3, 0xbe, 0xd3, 0xcd, 0xaa, 0x7c, 0x91, 0xd4, 0x15,
+  0x52, 0x72, 0xbd, 0x3f, 0x3e, 0x3c, 0xb0, 0xe9, 0xed, 0xf6, 0x12, 0xb2, 0x9c, 0xdd, 0x89, 0xd2,
+  0x23, 0x62, 0x1f, 0xe7, 0x08, 0xe4, 0xc9, 0x96, 0x15, 0xe5, 0xac, 0x03, 0x41, 0xd8, 0xf4, 0xb2,
+  0xa4, 0x46, 0x7d, 0x97, 0x98, 0x6a, 0x6e, 0x87, 0x53, 0x73, 0x3b, 0x6d, 0xd4, 0x2b, 0x3a, 0xbb,
+  0x85, 0x7a, 0x8d, 0xee, 0xc4, 0x47, 0x16, 0x3e, 0x3f, 0xb7, 0x85, 0x5f, 0xf5, 0x2f, 0xac, 0xae,
+  0x6c, 0x35, 0xb3, 0x62, 0x14, 0x25, 0x66, 0xa9, 0xbb, 0x33, 0xbb, 0x05, 0x4f, 0xe1, 0xa6, 0xd8,
+  0x07, 0x08, 0x02, 0xe8, 0xc3, 0x3b, 0x68, 0x1d, 0xe6, 0x8b, 0x5f, 0x2d, 0xf0, 0xc0, 0x59, 0xc7,
+  0x06, 0x05, 0x76, 0xfb, 0xe3, 0xe6, 0xaf, 0x9c, 0x16, 0xe8, 0x0a, 0xec, 0x3c, 0x55, 0x9a, 0x17,
+  0x3b, 0x85, 0x76, 0x79, 0x1e, 0x09, 0x92, 0x7c, 0x0e, 0x7b, 0xb6, 0x88, 0xb3, 0x1e, 0xfd, 0xd2,
+  0x5e, 0x6d, 0xaf, 0xd3, 0x45, 0x75, 0xa0, 0x28, 0x89, 0xf9, 0x11, 0x6a, 0x7b, 0x95, 0x4e, 0xcd,
+  0x74, 0xb2, 0x12, 0xa4, 0x9c, 0x00, 0x49, 0x53, 0x2e, 0xd9, 0x6e, 0x24, 0x62, 0xe6, 0xa0, 0x6e,
+  0xe4, 0xba, 0xa8, 0xad, 0xea, 0x80, 0xd7, 0xf6, 0x69, 0x58, 0x9d, 0x6d, 0xbd, 0x7d, 0xbe, 0x5b,
+  0xed, 0xa6, 0x3d, 0xb9, 0xf2, 0x0f, 0xee, 0x1f, 0x9e, 0xd1, 0xcb, 0xaa, 0xf8, 0x04, 0x00, 0x00,
+};
+const httpsserver::StaticBlob ASSET_HISTORY_HTML = {
+  ASSET_HISTORY_HTML_HEAD, sizeof(ASSET_HISTORY_HTML_HEAD) - 1,
+  ASSET_HISTORY_HTML_NOT_MODIFIED_HEAD, sizeof(ASSET_HISTORY_HTML_NOT_MODIFIED_HEAD) - 1,
+  ASSET_HISTORY_HTML_BODY, sizeof(ASSET_HISTORY_HTML_BODY),
+  "\"a4574fd2f70bdea4\"",
+  "gzip"
+};
+
+// upload.html: 3728 bytes, 1234 bytes with gzip (33%)
+const char ASSET_UPLOAD_HTML_HEAD[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/html; charset=UTF-8\r\n"
+  "Content-Encoding: gzip\r\n"
+  "Content-Length: 1234\r\n"
+  "ETag: \"bf50b82a48d64a32\"\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Vary: Accept-Encoding\r\n";
+const char ASSET_UPLOAD_HTML_NOT_MODIFIED_HEAD[] PROGMEM =
+  "HTTP/1.1 304 Not Modified\r\n"
+  "ETag: \"bf50b82a48d64a32\"\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Vary: Accept-Encoding\r\n";
+const uint8_t ASSET_UPLOAD_HTML_BODY[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x57, 0x5b, 0x6f, 0xdb, 0x36,
+  0x14, 0x7e, 0xcf, 0xaf, 0x60, 0x85, 0x02, 0x92, 0xb1, 0x54, 0x02, 0xd2, 0x97, 0x21, 0xb5, 0x3d,
+  0xac, 0xb1, 0x83, 0x0d, 0x68, 0x9a, 0x60, 0x49, 0x1e, 0x86, 0xa2, 0x58, 0x68, 0x89, 0x8e, 0x39,
+  0xd3, 0xa2, 0x46, 0x52, 0xf1, 0xbc, 0xc0, 0xff, 0x7d, 0xe7, 0x90, 0x94, 0x4c, 0xa9, 0xb6, 0xb3,
+  0xa0, 0x98, 0x5f, 0x4c, 0xf2, 0x7c, 0xe7, 0x7e, 0x21, 0x35, 0x7c, 0x33, 0xb9, 0xbe, 0xb8, 0xfb,
+  0xfd, 0x66, 0x4a, 0x16, 0x66, 0x25, 0xc6, 0x27, 0xc3, 0xe6, 0x8f, 0xd1, 0x62, 0x7c, 0x42, 0xc8,
+  0x70, 0xc5, 0x0c, 0x25, 0xf9, 0x82, 0x2a, 0xcd, 0xcc, 0x28, 0xba, 0xbf, 0xbb, 0x7c, 0xf7, 0x63,
+  0x64, 0x09, 0x86, 0x1b, 0xc1, 0xc6, 0xf7, 0x95, 0x90, 0xb4, 0x20, 0x97, 0x5c, 0xb0, 0x61, 0xe6,
+  0x8e, 0x4e, 0x86, 0x99, 0xe3, 0x1e, 0xce, 0x64, 0xb1, 0xb1, 0xd8, 0xc5, 0x59, 0x08, 0x24, 0x46,
+  0x92, 0xe9, 0xed, 0xcd, 0xfb, 0x33, 0x00, 0x9e, 0x59, 0xfa, 0x5c, 0xaa, 0x15, 0xe1, 0xc5, 0x28,
+  0xaa, 0x2d, 0xea, 0x12, 0xb6, 0x11, 0x61, 0x65, 0x6e, 0x36, 0x15, 0x1b, 0x45, 0xab, 0x5a, 0x18,
+  0x5e, 0x51, 0x65, 0x32, 0xc4, 0xbd, 0x2b, 0xa8, 0xa1, 0x11, 0x01, 0xbb, 0x16, 0x12, 0x38, 0x2a,
+  0xa9, 0x4d, 0x44, 0x68, 0x6e, 0xb8, 0x2c, 0x47, 0x51, 0x46, 0x2b, 0x9e, 0x39, 0x21, 0xd6, 0x4a,
+  0x90, 0xcd, 0xcb, 0xaa, 0x36, 0xc4, 0x49, 0x9a, 0x83, 0xf6, 0x88, 0x94, 0x74, 0xd5, 0xae, 0x15,
+  0xfb, 0xab, 0xe6, 0x8a, 0x15, 0x1e, 0x3c, 0xab, 0x8d, 0x91, 0xa5, 0x47, 0xeb, 0x7a, 0xb6, 0xe2,
+  0x26, 0xf2, 0xa6, 0x0f, 0x33, 0x47, 0xb4, 0x06, 0x5b, 0x4b, 0xec, 0xaa, 0xe0, 0x4f, 0xd6, 0x72,
+  0xc5, 0x34, 0x98, 0x19, 0x8d, 0x87, 0x19, 0x9c, 0x34, 0x14, 0x2f, 0x55, 0xd0, 0x19, 0x13, 0x04,
+  0x58, 0x40, 0xab, 0x14, 0x05, 0x53, 0xb7, 0x4c, 0xb0, 0x1c, 0xc0, 0xee, 0x9f, 0xb8, 0xc3, 0xf3,
+  0x61, 0x66, 0x81, 0x9e, 0x49, 0x3b, 0x1a, 0xca, 0xee, 0x30, 0x11, 0x59, 0x42, 0x3a, 0xca, 0x47,
+  0x30, 0x50, 0x70, 0x6d, 0x30, 0xa0, 0x3a, 0x19, 0x78, 0x6f, 0x81, 0x4f, 0x56, 0x18, 0x0a, 0xf2,
+  0x44, 0x45, 0x0d, 0x90, 0xac, 0xaa, 0x67, 0x82, 0xe7, 0xd1, 0xd8, 0x2f, 0x86, 0x99, 0xa3, 0x7b,
+  0x25, 0x99, 0xd3, 0xd2, 0xf5, 0x1e, 0x14, 0x00, 0x72, 0xd9, 0x93, 0xff, 0x1b, 0x9b, 0x83, 0x8f,
+  0x0b, 0x97, 0xc1, 0x4f, 0x40, 0xe9, 0x06, 0x24, 0xf0, 0xda, 0xda, 0xdc, 0xf2, 0x36, 0x79, 0x58,
+  0xbc, 0x1f, 0xdb, 0x3d, 0x24, 0xfd, 0xbd, 0x3f, 0xaa, 0x85, 0x73, 0x0f, 0x8e, 0x51, 0x20, 0x06,
+  0xaf, 0x16, 0xfb, 0xc5, 0xdd, 0x6b, 0xf6, 0xc8, 0x02, 0x51, 0xf7, 0x9a, 0x3e, 0xb2, 0x40, 0x54,
+  0x65, 0x51, 0x2b, 0xb6, 0x92, 0x6a, 0x63, 0x69, 0x28, 0xac, 0xea, 0xca, 0xd2, 0xb9, 0xe2, 0x95,
+  0xf7, 0xb5, 0x90, 0x79, 0xbd, 0x62, 0xa5, 0x49, 0x69, 0x51, 0x4c, 0x9f, 0x60, 0x81, 0x06, 0xb0,
+  0x92, 0xa9, 0x24, 0x9e, 0x5c, 0x5f, 0x5d, 0xc8, 0xd2, 0xe0, 0x19, 0xa4, 0x9d, 0x15, 0xf1, 0x29,
+  0x99, 0xd7, 0xa5, 0x2d, 0xb0, 0x64, 0x40, 0x9e, 0x7d, 0x9c, 0x83, 0xd8, 0x7c, 0xf0, 0x47, 0x8f,
+  0xcc, 0x5c, 0xed, 0x0c, 0x68, 0xce, 0xb7, 0xf0, 0xdf, 0x55, 0x09, 0xb8, 0xa9, 0x60, 0xb8, 0xfc,
+  0xb8, 0xf9, 0xb5, 0x48, 0xe2, 0x5d, 0xd1, 0xc7, 0x83, 0x54, 0x96, 0xae, 0xec, 0xc8, 0x88, 0x50,
+  0xbd, 0x29, 0xf3, 0x9d, 0x6e, 0xb6, 0x53, 0xce, 0xd2, 0x4a, 0x31, 0xb4, 0x7a, 0xc2, 0xe6, 0x14,
+  0xca, 0x6e, 0x67, 0x43, 0x0e, 0xfc, 0x58, 0x50, 0xd0, 0x4f, 0x23, 0x80, 0x19, 0xaa, 0x40, 0x5b,
+  0x97, 0x88, 0xfd, 0x03, 0xc4, 0x92, 0xad, 0x09, 0xea, 0x9c, 0xc0, 0x36, 0x41, 0x86, 0x9e, 0x0c,
+  0x57, 0xd0, 0x13, 0x88, 0xff, 0xe8, 0xb0, 0xe9, 0x0e, 0x14, 0xb7, 0xac, 0x2d, 0x53, 0x6a, 0xd8,
+  0xdf, 0xc6, 0x87, 0x11, 0x04, 0x44, 0xae, 0x87, 0x78, 0xf9, 0x98, 0xa6, 0x69, 0xd4, 0xa0, 0x8d,
+  0xda, 0xb4, 0x2e, 0x05, 0x6a, 0xd1, 0xf5, 0x35, 0x85, 0x10, 0xcc, 0x99, 0xc9, 0x17, 0xd6, 0xb6,
+  0xd4, 0x35, 0xf8, 0x69, 0x00, 0x27, 0x7e, 0x04, 0x9c, 0x93, 0xf8, 0xe6, 0xfa, 0xf6, 0x2e, 0x3e,
+  0x0d, 0x28, 0x38, 0x78, 0xce, 0xad, 0xa3, 0xed, 0xe1, 0xb6, 0xb5, 0xb1, 0xd1, 0x84, 0x16, 0xb6,
+  0xaa, 0x40, 0xad, 0x35, 0x39, 0x09, 0x60, 0x87, 0x9c, 0xc1, 0xdd, 0x0e, 0xb5, 0xa7, 0x10, 0xb6,
+  0x24, 0xa7, 0x60, 0x39, 0x49, 0x98, 0x52, 0x83, 0xc0, 0xe4, 0x17, 0xa2, 0x43, 0xe6, 0x14, 0xe4,
+  0x80, 0x43, 0x11, 0xf9, 0x81, 0x00, 0x6b, 0x2b, 0xce, 0xd5, 0x91, 0x2f, 0xa3, 0x6e, 0x55, 0x84,
+  0xea, 0x5b, 0x4d, 0xbe, 0x08, 0x7c, 0x5b, 0x1d, 0xcb, 0x5f, 0x83, 0xd9, 0x65, 0xb0, 0x39, 0x49,
+  0x79, 0x09, 0xdd, 0xf0, 0xcb, 0xdd, 0xd5, 0x27, 0xe0, 0x8f, 0xe3, 0x7e, 0x7d, 0xe1, 0x40, 0x3a,
+  0x2a, 0x38, 0x18, 0x59, 0x50, 0xd5, 0x76, 0x1a, 0xbd, 0x2e, 0xed, 0xb1, 0x9d, 0xe5, 0x73, 0x9d,
+  0xa1, 0x87, 0x3f, 0x15, 0x5c, 0x8d, 0x62, 0x08, 0x8b, 0x93, 0x1b, 0x24, 0x89, 0xcf, 0x49, 0xf2,
+  0x06, 0xb3, 0x27, 0x97, 0x03, 0x62, 0x16, 0x4a, 0xae, 0x6d, 0x65, 0x4f, 0x95, 0x92, 0xd0, 0xcb,
+  0x9f, 0x99, 0x59, 0x4b, 0xb5, 0x44, 0xf1, 0x15, 0xe8, 0x61, 0x64, 0x4d, 0x35, 0x29, 0xa5, 0x21,
+  0x72, 0x19, 0x7f, 0x53, 0x10, 0xe8, 0xba, 0xee, 0x54, 0xc4, 0x9f, 0x1a, 0x7b, 0x7e, 0x87, 0xb3,
+  0x88, 0x14, 0x0a, 0x72, 0x4a, 0xb1, 0x30, 0x71, 0x12, 0x8e, 0xc6, 0x9d, 0x9a, 0x74, 0x92, 0x04,
+  0x0f, 0x63, 0x93, 0x2b, 0x46, 0x0d, 0xf3, 0xe1, 0x49, 0x62, 0xc1, 0x43, 0xd5, 0x58, 0x40, 0xbd,
+  0x72, 0x78, 0x78, 0xfb, 0x8c, 0xa2, 0x53, 0xbc, 0xa7, 0xb6, 0x24, 0xf1, 0x3b, 0xcd, 0xff, 0x81,
+  0xdd, 0x6c, 0x63, 0x98, 0x1e, 0x3c, 0x84, 0xfc, 0x18, 0x01, 0x8b, 0xe0, 0x7a, 0xc2, 0x3b, 0xf5,
+  0xb6, 0x33, 0x68, 0x66, 0xca, 0x23, 0x16, 0xb9, 0x39, 0xde, 0xb5, 0x8a, 0x20, 0x4f, 0xcf, 0xb0,
+  0xf8, 0xba, 0x62, 0x65, 0xfc, 0x2d, 0xca, 0x5f, 0x18, 0x80, 0xd8, 0x33, 0x28, 0x9b, 0x1f, 0xbc,
+  0x1f, 0x2e, 0x6d, 0xf2, 0x92, 0xd6, 0xb9, 0x9e, 0xc2, 0x6d, 0x77, 0x0b, 0x71, 0xa1, 0x15, 0x28,
+  0x2c, 0x2e, 0x16, 0x5c, 0x14, 0x09, 0x28, 0xea, 0xe0, 0xb7, 0x84, 0x09, 0x48, 0xe8, 0x3e, 0x6f,
+  0x05, 0x2f, 0x97, 0x47, 0xdc, 0xa5, 0x7d, 0x4f, 0x11, 0x9f, 0x2e, 0x14, 0x9b, 0xa3, 0x07, 0x8d,
+  0x71, 0x7b, 0x20, 0xbd, 0x68, 0x90, 0x2f, 0x13, 0xb9, 0x2e, 0xb1, 0x73, 0xbf, 0xc6, 0xfb, 0xd0,
+  0x76, 0xf6, 0x22, 0xf0, 0x8f, 0x99, 0xa0, 0xe5, 0x32, 0x3e, 0xea, 0x1e, 0xb2, 0x74, 0xfd, 0x0b,
+  0xd6, 0x6d, 0x53, 0x76, 0x39, 0x02, 0xfc, 0xf6, 0xc5, 0xe1, 0x83, 0xa1, 0x91, 0xe0, 0x1b, 0x73,
+  0x9d, 0x61, 0x1b, 0xc4, 0xb5, 0x1a, 0x4c, 0x65, 0xab, 0xc1, 0xce, 0x92, 0x73, 0xb8, 0xee, 0x90,
+  0xb3, 0x37, 0x7c, 0x5a, 0x31, 0x59, 0x46, 0x7e, 0x16, 0x6b, 0xba, 0xd1, 0x04, 0x6e, 0x4e, 0xe2,
+  0x5f, 0x15, 0x58, 0x83, 0xd8, 0x55, 0x70, 0x2b, 0x69, 0x08, 0x4e, 0xb7, 0x39, 0xbf, 0xc0, 0xc8,
+  0x77, 0xcf, 0x8c, 0xd4, 0xbd, 0x3d, 0xf4, 0xd7, 0x54, 0xcb, 0x15, 0x4b, 0x24, 0x36, 0x8f, 0x74,
+  0xb3, 0x81, 0x8c, 0x46, 0x10, 0x28, 0x27, 0x2d, 0x1e, 0x0c, 0xf6, 0xf4, 0x14, 0xf0, 0x1e, 0xc9,
+  0xa9, 0x93, 0xdc, 0x4d, 0x2c, 0x9c, 0x35, 0xc2, 0x5b, 0xd1, 0x7d, 0x7a, 0x2f, 0xa5, 0xd9, 0x1e,
+  0x98, 0xb7, 0x3d, 0x0c, 0x3d, 0x70, 0x1e, 0xd6, 0xf4, 0xa2, 0x8e, 0xd7, 0x49, 0xdf, 0x7e, 0x57,
+  0x5e, 0x95, 0x94, 0xcd, 0xb8, 0xd6, 0x87, 0x52, 0x6b, 0xff, 0xda, 0x0b, 0x25, 0xe8, 0x53, 0x37,
+  0x6b, 0x7b, 0xd7, 0x8a, 0x7f, 0x97, 0xfe, 0xe7, 0xd9, 0xdf, 0x68, 0xf3, 0x8e, 0x36, 0x61, 0x72,
+  0xa0, 0x0f, 0x87, 0x5e, 0x53, 0xdb, 0xbd, 0x97, 0x5d, 0xff, 0x85, 0xd5, 0x9a, 0xf6, 0xca, 0x2b,
+  0xa5, 0x46, 0xf6, 0xf8, 0xff, 0xb9, 0x45, 0xfc, 0xf3, 0xea, 0xf0, 0x25, 0x72, 0x30, 0x6e, 0xc1,
+  0xeb, 0x15, 0xae, 0xcc, 0x6e, 0xd5, 0x04, 0x15, 0xf3, 0x70, 0x27, 0x0d, 0x15, 0xe7, 0xe4, 0xed,
+  0x33, 0xaa, 0x4a, 0x0d, 0xee, 0x3e, 0xe2, 0xb5, 0xe0, 0x6f, 0x87, 0x53, 0x02, 0x8f, 0xe5, 0xa2,
+  0xa5, 0xd7, 0xb0, 0xe9, 0x92, 0x2f, 0x15, 0x63, 0x2d, 0x19, 0x1e, 0xf5, 0x2c, 0x24, 0x3f, 0x7c,
+  0xdf, 0x1c, 0x71, 0x3e, 0x10, 0x1b, 0xe0, 0xc3, 0xa3, 0x04, 0xbe, 0x3b, 0xfc, 0x5b, 0x1c, 0x3e,
+  0x22, 0xec, 0x47, 0x22, 0x3c, 0xe5, 0xed, 0x87, 0xe7, 0xbf, 0xf1, 0x5f, 0xcd, 0x4d, 0x90, 0x0e,
+  0x00, 0x00,
+};
+const httpsserver::StaticBlob ASSET_UPLOAD_HTML = {
+  ASSET_UPLOAD_HTML_HEAD, sizeof(ASSET_UPLOAD_HTML_HEAD) - 1,
+  ASSET_UPLOAD_HTML_NOT_MODIFIED_HEAD, sizeof(ASSET_UPLOAD_HTML_NOT_MODIFIED_HEAD) - 1,
+  ASSET_UPLOAD_HTML_BODY, sizeof(ASSET_UPLOAD_HTML_BODY),
+  "\"bf50b82a48d64a32\"",
+  "gzip"
+};
+
+#endif /* ASSETS_BUNDLE_H */
@@ -3,7 +3,8 @@
 namespace httpsserver {
 
 ConnectionContext::ConnectionContext() {
-
+  _outputFillSize = 0;
+  _outputSentSize = 0;
 }
 
 ConnectionContext::~ConnectionContext() {
@@ -14,4 +15,67 @@ void ConnectionContext::setWebsocketHandler(WebsocketHandler *wsHandler) {
   _wsHandler = wsHandler;
 }
 
+/**
+ * Queues data for the client. Small writes are collected in the output buffer, which is sent once it
+ * is full or flushOutput() is called. Large blocks of data are sent without copying them, as soon as
+ * the output buffer is empty.
+ *
+ * Returns the number of bytes that have been accepted, or 0 if the connection is broken.
+ */
+size_t ConnectionContext::writeBuffer(byte* buffer, size_t length) {
+  size_t accepted = 0;
+  while (accepted < length) {
+    size_t remaining = length - accepted;
+    if (_outputFillSize == 0 && remaining >= HTTPS_CONNECTION_OUTPUT_BUFFER_SIZE) {
+      while (accepted < length) {
+        int res = (int)writeBytesFromBuffer(buffer + accepted, length - accepted);
+        if (res <= 0) {
+          return 0;
+        }
+        accepted += res;
+      }
+      break;
+    }
+
+    // Fill up the output buffer, and send it if it is full
+    size_t chunkSize = HTTPS_CONNECTION_OUTPUT_BUFFER_SIZE - _outputFillSize;
+    if (chunkSize > remaining) {
+      chunkSize = remaining;
+    }
+    memcpy(_outputBuffer + _outputFillSize, buffer + accepted, chunkSize);
+    _outputFillSize += chunkSize;
+    accepted += chunkSize;
+    if (_outputFillSize == HTTPS_CONNECTION_OUTPUT_BUFFER_SIZE && !flushOutput()) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+/**
+ * Sends everything that is in the output buffer. Has to be called at the end of each response or
+ * message. Returns false if the data could not be sent, in which case it is discarded.
+ */
+bool ConnectionContext::flushOutput() {
+  while (_outputSentSize < _outputFillSize) {
+    int res = (int)writeBytesFromBuffer(_outputBuffer + _outputSentSize, _outputFillSize - _outputSentSize);
+    if (res <= 0) {
+      HTTPS_LOGW("Could not send %d bytes of output", _outputFillSize - _outputSentSize);
+      discardOutput();
+      return false;
+    }
+    _outputSentSize += res;
+  }
+  discardOutput();
+  return true;
+}
+
+/**
+ * Clears the output buffer without sending it, e.g. when the connection is closed
+ */
+void ConnectionContext::discardOutput() {
+  _outputFillSize = 0;
+  _outputSentSize = 0;
+}
+
 } /* namespace httpsserver */
@@ -8,6 +8,8 @@
 #include "openssl/ssl.h"
 #undef read
 
+#include "HTTPSServerConstants.hpp"
+
 namespace httpsserver {
 
 class WebsocketHandler;
@@ -23,17 +25,36 @@ public:
   virtual void signalRequestError() = 0;
   virtual void signalClientClose() = 0;
   virtual size_t getCacheSize() = 0;
+  virtual bool supportsChunkedEncoding() = 0;
 
   virtual size_t readBuffer(byte* buffer, size_t length) = 0;
+  virtual size_t peekBuffer(const byte ** data) = 0;
+  virtual void consumeBuffer(size_t length) = 0;
   virtual size_t pendingBufferSize() = 0;
+  virtual bool waitForData(unsigned long timeoutMs) = 0;
+  virtual bool isClientClosed() = 0;
 
-  virtual size_t writeBuffer(byte* buffer, size_t length) = 0;
+  virtual size_t writeBuffer(byte* buffer, size_t length);
+  virtual bool flushOutput();
 
   virtual bool isSecure() = 0;
   virtual void setWebsocketHandler(WebsocketHandler *wsHandler);
   virtual IPAddress getClientIP() = 0;
 
   WebsocketHandler * _wsHandler;
+
+protected:
+  // Sends data to the client without buffering. May send less than length bytes
+  virtual size_t writeBytesFromBuffer(byte* buffer, size_t length) = 0;
+  void discardOutput();
+
+private:
+  // Collects small writes, so that they are sent in a single TLS record and TCP segment
+  byte _outputBuffer[HTTPS_CONNECTION_OUTPUT_BUFFER_SIZE];
+  // Number of bytes in _outputBuffer
+  size_t _outputFillSize;
+  // Number of bytes at the start of _outputBuffer that have already been sent
+  size_t _outputSentSize;
 };
 
 } /* namespace httpsserver */
@@ -4,25 +4,57 @@ namespace httpsserver {
 
 HTTPConnection::HTTPConnection(ResourceResolver * resResolver):
   _resResolver(resResolver) {
+  // The headers are kept for the lifetime of the connection object and are only cleared between requests
+  _httpHeaders = new HTTPHeaders();
+  _responseHeaders = new HTTPHeaders();
+  _responseCache = NULL;
+  _wsHandler = nullptr;
+  reset();
+}
+
+HTTPConnection::~HTTPConnection() {
+  // Close the socket
+  closeConnection();
+
+  delete _httpHeaders;
+  delete _responseHeaders;
+  delete[] _responseCache;
+}
+
+/**
+ * Resets a closed connection to its initial state, so that the object can be reused for the next
+ * client by calling initialize() again. The server keeps a pool of connection objects this way,
+ * instead of allocating new ones for every client.
+ */
+void HTTPConnection::reset() {
   _socket = -1;
   _addrLen = 0;
 
-  _bufferProcessed = 0;
-  _bufferUnusedIdx = 0;
+  _bufferReadIdx = 0;
+  _bufferFillSize = 0;
+  discardOutput();
 
   _connectionState = STATE_UNDEFINED;
   _clientState = CSTATE_UNDEFINED;
-  _httpHeaders = NULL;
   _defaultHeaders = NULL;
   _isKeepAlive = false;
+  _isHttp11 = false;
   _lastTransmissionTS = millis();
+  _requestStartTS = 0;
   _shutdownTS = 0;
-  _wsHandler = nullptr;
-}
+  _readReadyKnown = false;
+  _readReady = false;
 
-HTTPConnection::~HTTPConnection() {
-  // Close the socket
-  closeConnection();
+  resetParser();
+  _httpMethod.clear();
+  _httpResource.clear();
+  _httpHeaders->clearAll();
+  _responseHeaders->clearAll();
+
+  if (_wsHandler != nullptr) {
+    delete _wsHandler;
+    _wsHandler = nullptr;
+  }
 }
 
 /**
@@ -35,17 +67,24 @@ int HTTPConnection::initialize(int serverSocketID, HTTPHeaders *defaultHeaders)
     _defaultHeaders = defaultHeaders;
     _addrLen = sizeof(_sockAddr);
     _socket = accept(serverSocketID, (struct sockaddr * )&_sockAddr, &_addrLen);
+    _readReadyKnown = false;
 
     // Build up SSL Connection context if the socket has been created successfully
     if (_socket >= 0) {
       HTTPS_LOGI("New connection. Socket FID=%d", _socket);
+      // The server socket is non-blocking. Make sure that the client socket is not.
+      fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) & ~O_NONBLOCK);
       _connectionState = STATE_INITIAL;
-      _httpHeaders = new HTTPHeaders();
       refreshTimeout();
       return _socket;
     }
      
-    HTTPS_LOGE("Could not accept() new connection");
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      // The server socket is non-blocking, so this just means there is no pending connection
+      HTTPS_LOGD("No pending connection");
+    } else {
+      HTTPS_LOGE("Could not accept() new connection");
+    }
    
     _addrLen = 0;
     _connectionState = STATE_ERROR;
@@ -74,9 +113,29 @@ IPAddress HTTPConnection::getClientIP() {
  * True if the connection is timed out.
  *
  * (Should be checkd in the loop and transition should go to CONNECTION_CLOSE if exceeded)
+ *
+ * Websocket connections do not time out, as loop() is only called for them when there is data.
+ * Closing connections are limited by HTTPS_SHUTDOWN_TIMEOUT in closeConnection() instead.
  */
 bool HTTPConnection::isTimeoutExceeded() {
-  return _lastTransmissionTS + HTTPS_CONNECTION_TIMEOUT < millis();
+  return _connectionState != STATE_WEBSOCKET && _connectionState != STATE_CLOSING &&
+    _lastTransmissionTS + HTTPS_CONNECTION_TIMEOUT < millis();
+}
+
+/**
+ * Returns the time (in ms) until isTimeoutExceeded() will become true, or 0 if it already is. For
+ * a closing connection, it is the time until the shutdown is given up.
+ */
+unsigned long HTTPConnection::getMillisUntilTimeout() {
+  if (_connectionState == STATE_WEBSOCKET) {
+    return ULONG_MAX;
+  }
+  if (_connectionState == STATE_CLOSING) {
+    unsigned long elapsed = millis() - _shutdownTS;
+    return elapsed <= HTTPS_SHUTDOWN_TIMEOUT ? HTTPS_SHUTDOWN_TIMEOUT - elapsed + 1 : 0;
+  }
+  unsigned long elapsed = millis() - _lastTransmissionTS;
+  return elapsed <= HTTPS_CONNECTION_TIMEOUT ? HTTPS_CONNECTION_TIMEOUT - elapsed + 1 : 0;
 }
 
 /**
@@ -93,6 +152,13 @@ bool HTTPConnection::isClosed() {
   return (_connectionState == STATE_ERROR || _connectionState == STATE_CLOSED);
 }
 
+/**
+ * Returns true, if the connection object is not in use and can be initialized for a new client.
+ */
+bool HTTPConnection::isFree() {
+  return (_connectionState == STATE_UNDEFINED);
+}
+
 /**
  * Returns true, if the connection has been closed due to error
  */
@@ -100,6 +166,77 @@ bool HTTPConnection::isError() {
   return (_connectionState == STATE_ERROR);
 }
 
+/**
+ * Returns the socket of this connection, or -1 if there is none.
+ */
+int HTTPConnection::getSocket() {
+  return _socket;
+}
+
+/**
+ * Used by the server to pass the result of its select() call on to the connection before
+ * calling loop(), so that the connection does not need to call select() on its own.
+ *
+ * The value is used for the next check for incoming data only. Any later check (e.g. while the
+ * request handler reads the body) queries the socket again.
+ */
+void HTTPConnection::setReadReady(bool readReady) {
+  _readReadyKnown = true;
+  _readReady = readReady;
+}
+
+/**
+ * Returns true, if loop() has to be called even though the socket is neither readable nor
+ * writable. This is the case if data has been received but not processed yet, if the request
+ * is being processed or if a timeout has to be handled. A closing connection only waits for the
+ * client to confirm the shutdown, which makes the socket readable, or for getMillisUntilTimeout().
+ */
+bool HTTPConnection::hasPendingWork() {
+  if (isClosed()) {
+    return false;
+  }
+  if (_connectionState == STATE_CLOSING) {
+    return getMillisUntilTimeout() == 0;
+  }
+  // While parsing a line, every byte but a trailing \r is consumed at once. So a single byte
+  // left in the buffer means that we wait for the rest of the line to arrive.
+  bool bufferPending = _bufferFillSize > 1 ||
+    (_bufferFillSize == 1 && _connectionState > STATE_REQUEST_FINISHED);
+  return bufferPending ||
+    pendingByteCount() > 0 ||
+    _clientState == CSTATE_CLOSED ||
+    _connectionState == STATE_HEADERS_FINISHED ||
+    _connectionState == STATE_BODY_FINISHED ||
+    isTimeoutExceeded();
+}
+
+/**
+ * Returns true, if the connection has been kept alive after a request and waits for the next one,
+ * without having received any part of it. Closing such a connection does not lose any data.
+ */
+bool HTTPConnection::isIdleKeepAlive() {
+  return _connectionState == STATE_INITIAL &&
+    _isKeepAlive &&
+    _clientState == CSTATE_ACTIVE &&
+    _headLength == 0 &&
+    _bufferFillSize == 0 &&
+    pendingByteCount() == 0;
+}
+
+/**
+ * Returns the time since the last transmission on this connection
+ */
+unsigned long HTTPConnection::getIdleMillis() {
+  return millis() - _lastTransmissionTS;
+}
+
+/**
+ * Returns true, if the connection waits for the socket to become writable.
+ */
+bool HTTPConnection::wantsWrite() {
+  return false;
+}
+
 bool HTTPConnection::isSecure() {
   return false;
 }
@@ -109,6 +246,11 @@ void HTTPConnection::closeConnection() {
 
   if (_connectionState != STATE_ERROR && _connectionState != STATE_CLOSED) {
 
+    // Send what is left of the response before the socket is closed
+    if (_connectionState != STATE_CLOSING) {
+      flushOutput();
+    }
+
     // First call to closeConnection - set the timestamp to calculate the timeout later on
     if (_connectionState != STATE_CLOSING) {
       _shutdownTS = millis();
@@ -131,11 +273,9 @@ void HTTPConnection::closeConnection() {
     _connectionState = STATE_CLOSED;
   }
 
-  if (_httpHeaders != NULL) {
-    HTTPS_LOGD("Free headers");
-    delete _httpHeaders;
-    _httpHeaders = NULL;
-  }
+  HTTPS_LOGD("Clear headers");
+  _httpHeaders->clearAll();
+  _responseHeaders->clearAll();
 
   if (_wsHandler != nullptr) {
     HTTPS_LOGD("Free WS Handler");
@@ -145,80 +285,83 @@ void HTTPConnection::closeConnection() {
 }
 
 /**
- * This method will try to fill up the buffer with data from
+ * This method will try to fill up the buffer with data from the socket.
+ *
+ * _receiveBuffer is used as a ring buffer, so processed data is never moved. New data is
+ * appended behind the unprocessed data, wrapping around at the end of the buffer:
+ *
+ * Host: test\\Foo: bar\\\\[free space           ]GET / HTTP/1.1\\
+ *                         ^ readIdx + fillSize     ^ readIdx
  */
 int HTTPConnection::updateBuffer() {
   if (!isClosed()) {
 
-    // If there is buffer data that has been marked as processed.
-    // Some example is shown here:
-    //
-    // Previous configuration:
-    // GET / HTTP/1.1\\Host: test\\Foo: bar\\\\[some uninitialized memory]
-    //                 ^ processed             ^ unusedIdx
-    //
-    // New configuration after shifting:
-    // Host: test\\Foo: bar\\\\[some uninitialized memory]
-    // ^ processed             ^ unusedIdx
-    if (_bufferProcessed > 0) {
-      for(int i = 0; i < HTTPS_CONNECTION_DATA_CHUNK_SIZE; i++) {
-        int copyFrom = i + _bufferProcessed;
-        if (copyFrom < _bufferUnusedIdx) {
-          _receiveBuffer[i] = _receiveBuffer[copyFrom];
-        } else {
-          break;
-        }
-      }
-      _bufferUnusedIdx -= _bufferProcessed;
-      _bufferProcessed = 0;
-
+    // If everything has been processed, start over at the beginning of the buffer, so that the
+    // next read can use the whole buffer in one go
+    if (_bufferFillSize == 0) {
+      _bufferReadIdx = 0;
     }
 
-    if (_bufferUnusedIdx < HTTPS_CONNECTION_DATA_CHUNK_SIZE) {
-      if (canReadData()) {
-
-        HTTPS_LOGD("Data on Socket FID=%d", _socket);
-
-        int readReturnCode;
-
-        // The return code of SSL_read means:
-        // > 0 : Length of the data that has been read
-        // < 0 : Error
-        // = 0 : Connection closed
-        readReturnCode = readBytesToBuffer(
-            // Only after the part of the buffer that has not been processed yet
-            (byte*)(_receiveBuffer + sizeof(char) * _bufferUnusedIdx),
-            // Only append up to the end of the buffer
-            HTTPS_CONNECTION_DATA_CHUNK_SIZE - _bufferUnusedIdx
-        );
-
-        if (readReturnCode > 0) {
-          _bufferUnusedIdx += readReturnCode;
-          refreshTimeout();
-          return readReturnCode;
-
-        } else if (readReturnCode == 0) {
-          // The connection has been closed by the client
-          _clientState = CSTATE_CLOSED;
-          HTTPS_LOGI("Client closed connection, FID=%d", _socket);
-          // TODO: If we are in state websocket, we might need to do something here
-          return 0;
-        } else {
-          // An error occured
-          _connectionState = STATE_ERROR;
-          HTTPS_LOGE("An receive error occured, FID=%d", _socket);
-          closeConnection();
-          return -1;
+    int bytesReceived = 0;
+
+    // The free space may be split in two parts (at the end and at the start of the buffer), so
+    // we try to read a second time if the first read filled the first part completely.
+    while (_bufferFillSize < HTTPS_CONNECTION_DATA_CHUNK_SIZE && canReadData()) {
+
+      HTTPS_LOGD("Data on Socket FID=%d", _socket);
+
+      // Only append directly after the unprocessed data, and only up to the end of the buffer
+      // or up to the start of the unprocessed data (whatever comes first)
+      size_t writeIdx = (_bufferReadIdx + _bufferFillSize) % HTTPS_CONNECTION_DATA_CHUNK_SIZE;
+      size_t writeLength = (writeIdx >= _bufferReadIdx) ?
+        HTTPS_CONNECTION_DATA_CHUNK_SIZE - writeIdx :
+        _bufferReadIdx - writeIdx;
+
+      int readReturnCode;
+
+      // The return code of SSL_read means:
+      // > 0 : Length of the data that has been read
+      // < 0 : Error
+      // = 0 : Connection closed
+      readReturnCode = readBytesToBuffer((byte*)(_receiveBuffer + writeIdx), writeLength);
+
+      if (readReturnCode > 0) {
+        _bufferFillSize += readReturnCode;
+        bytesReceived += readReturnCode;
+        refreshTimeout();
+        if ((size_t)readReturnCode < writeLength) {
+          // No more data available right now
+          break;
         }
 
-      } // data pending
+      } else if (readReturnCode == 0) {
+        // The connection has been closed by the client
+        _clientState = CSTATE_CLOSED;
+        HTTPS_LOGI("Client closed connection, FID=%d", _socket);
+        // TODO: If we are in state websocket, we might need to do something here
+        break;
+      } else {
+        // An error occured
+        _connectionState = STATE_ERROR;
+        HTTPS_LOGE("An receive error occured, FID=%d", _socket);
+        closeConnection();
+        return -1;
+      }
+
+    } // buffer can read more and data pending
 
-    } // buffer can read more
+    return bytesReceived;
   }
   return 0;
 }
 
 bool HTTPConnection::canReadData() {
+  // Use the result of the server's select() call, if it has not been used yet
+  if (_readReadyKnown) {
+    _readReadyKnown = false;
+    return _readReady;
+  }
+
   fd_set sockfds;
   FD_ZERO( &sockfds );
   FD_SET(_socket, &sockfds);
@@ -238,31 +381,98 @@ bool HTTPConnection::canReadData() {
 
 size_t HTTPConnection::readBuffer(byte* buffer, size_t length) {
   updateBuffer();
-  size_t bufferSize = _bufferUnusedIdx - _bufferProcessed;
 
-  if (length > bufferSize) {
-    length = bufferSize;
+  // Copy in (at most) two chunks: Up to the end of the buffer and from its start
+  size_t bytesRead = 0;
+  while (bytesRead < length) {
+    const byte * data;
+    size_t available = peekBuffer(&data);
+    if (available == 0) {
+      break;
+    }
+    if (available > length - bytesRead) {
+      available = length - bytesRead;
+    }
+    memcpy(buffer + bytesRead, data, available);
+    consumeBuffer(available);
+    bytesRead += available;
   }
 
-  // Write until length is reached (either by param of by empty buffer
-  for(int i = 0; i < length; i++) {
-    buffer[i] = _receiveBuffer[_bufferProcessed++];
+  return bytesRead;
+}
+
+/**
+ * Provides access to the next contiguous span of unprocessed bytes in the receive buffer
+ * without copying them.
+ *
+ * The span stays valid until the buffer is updated the next time. Use consumeBuffer() to mark
+ * (a part of) it as processed. As the buffer wraps around, the span may be shorter than the
+ * total amount of unprocessed data.
+ *
+ * If there is no unprocessed data, the buffer is updated from the socket first.
+ *
+ * Returns the length of the span.
+ */
+size_t HTTPConnection::peekBuffer(const byte ** data) {
+  if (_bufferFillSize == 0) {
+    updateBuffer();
   }
+  *data = (const byte*)(_receiveBuffer + _bufferReadIdx);
+  size_t tailLength = HTTPS_CONNECTION_DATA_CHUNK_SIZE - _bufferReadIdx;
+  return _bufferFillSize < tailLength ? _bufferFillSize : tailLength;
+}
 
-  return length;
+/**
+ * Marks length bytes at the start of the receive buffer as processed.
+ */
+void HTTPConnection::consumeBuffer(size_t length) {
+  if (length > _bufferFillSize) {
+    length = _bufferFillSize;
+  }
+  _bufferReadIdx = (_bufferReadIdx + length) % HTTPS_CONNECTION_DATA_CHUNK_SIZE;
+  _bufferFillSize -= length;
 }
 
 size_t HTTPConnection::pendingBufferSize() {
   updateBuffer();
 
-  return _bufferUnusedIdx - _bufferProcessed + pendingByteCount();
+  return _bufferFillSize + pendingByteCount();
+}
+
+/**
+ * Waits up to timeoutMs for data from the client, without reading it. Returns true if data is
+ * available, false after the timeout or if the client has closed the connection.
+ */
+bool HTTPConnection::waitForData(unsigned long timeoutMs) {
+  if (_bufferFillSize > 0 || pendingByteCount() > 0) {
+    return true;
+  }
+  if (isClientClosed()) {
+    return false;
+  }
+
+  fd_set sockfds;
+  FD_ZERO(&sockfds);
+  FD_SET(_socket, &sockfds);
+  timeval timeout;
+  timeout.tv_sec  = timeoutMs / 1000;
+  timeout.tv_usec = (timeoutMs % 1000) * 1000;
+  return select(_socket + 1, &sockfds, NULL, NULL, &timeout) > 0;
+}
+
+/**
+ * Returns true if the client has closed the connection or it has been closed due to an error, so
+ * that no more data will arrive
+ */
+bool HTTPConnection::isClientClosed() {
+  return _clientState == CSTATE_CLOSED || isClosed() || _socket < 0;
 }
 
 size_t HTTPConnection::pendingByteCount() {
   return 0; // FIXME: Add the value of the equivalent function of SSL_pending() here
 }
 
-size_t HTTPConnection::writeBuffer(byte* buffer, size_t length) {
+size_t HTTPConnection::writeBytesFromBuffer(byte* buffer, size_t length) {
   return send(_socket, buffer, length, 0);
 }
 
@@ -274,48 +484,140 @@ void HTTPConnection::raiseError(uint16_t code, std::string reason) {
   _connectionState = STATE_ERROR;
   std::string sCode = intToString(code);
 
-  char headers[] = "\r\nConnection: close\r\nContent-Type: text/plain;charset=utf8\r\n\r\n";
-  writeBuffer((byte*)"HTTP/1.1 ", 9);
-  writeBuffer((byte*)sCode.c_str(), sCode.length());
-  writeBuffer((byte*)" ", 1);
-  writeBuffer((byte*)(reason.c_str()), reason.length());
-  writeBuffer((byte*)headers, strlen(headers));
-  writeBuffer((byte*)sCode.c_str(), sCode.length());
-  writeBuffer((byte*)" ", 1);
-  writeBuffer((byte*)(reason.c_str()), reason.length());
+  // Head and body are sent with a single write
+  std::string response;
+  response.reserve(96 + 2 * (sCode.length() + reason.length()));
+  response.append("HTTP/1.1 ");
+  response.append(sCode);
+  response.append(" ");
+  response.append(reason);
+  response.append("\r\nConnection: close\r\nContent-Type: text/plain;charset=utf8\r\n\r\n");
+  response.append(sCode);
+  response.append(" ");
+  response.append(reason);
+  writeBuffer((byte*)response.data(), response.length());
+  flushOutput();
   closeConnection();
 }
 
-void HTTPConnection::readLine(int lengthLimit) {
-  while(_bufferProcessed < _bufferUnusedIdx) {
-    char newChar = _receiveBuffer[_bufferProcessed];
-
-    if ( newChar == '\r') {
-      // Look ahead for \n (if not possible, wait for next round
-      if (_bufferProcessed+1 < _bufferUnusedIdx) {
-        if (_receiveBuffer[_bufferProcessed+1] == '\n') {
-          _bufferProcessed += 2;
-          _parserLine.parsingFinished = true;
-          return;
-        } else {
-          // Line has not been terminated by \r\n
-          HTTPS_LOGW("Line without \\r\\n (got only \\r). FID=%d", _socket);
-          raiseError(400, "Bad Request");
-          return;
-        }
-      }
-    } else {
-      _parserLine.text += newChar;
-      _bufferProcessed += 1;
-    }
+/**
+ * Prepares the parser for the head of the next request
+ */
+void HTTPConnection::resetParser() {
+  _headLength = 0;
+  _lineStart = 0;
+  _headerCount = 0;
+  memset(&_requestLine, 0, sizeof(_requestLine));
+}
 
-    // Check that the max request string size is not exceeded
-    if (_parserLine.text.length() > lengthLimit) {
+/**
+ * Moves data from the receive buffer to the head buffer, up to the end of the current line.
+ *
+ * Returns true if the line is complete. It then starts at _lineStart and ends with \r\n at
+ * _headLength. Returns false if more data is needed or an error has been raised.
+ */
+bool HTTPConnection::readLine(size_t lengthLimit) {
+  while(_bufferFillSize > 0) {
+    const byte * data;
+    size_t available = peekBuffer(&data);
+
+    // Take everything up to and including the next \n in one go
+    const byte * lineEnd = (const byte*)memchr(data, '\n', available);
+    size_t copyLength = (lineEnd == NULL) ? available : (lineEnd - data) + 1;
+
+    // Check that neither the line nor the whole head exceed their limits (+2 for the \r\n)
+    size_t lineLength = _headLength - _lineStart + copyLength;
+    if (lineLength > lengthLimit + 2 || _headLength + copyLength > HTTPS_REQUEST_MAX_HEAD_SIZE) {
       HTTPS_LOGW("Header length exceeded. FID=%d", _socket);
       raiseError(431, "Request Header Fields Too Large");
-      return;
+      return false;
+    }
+
+    memcpy(_headBuffer + _headLength, data, copyLength);
+    _headLength += copyLength;
+    consumeBuffer(copyLength);
+
+    if (lineEnd != NULL) {
+      // The line has to end with \r\n, and a \r must not appear anywhere else
+      size_t textLength = _headLength - _lineStart - 1;
+      if (textLength == 0 || _headBuffer[_headLength - 2] != '\r' ||
+          memchr(_headBuffer + _lineStart, '\r', textLength - 1) != NULL) {
+        HTTPS_LOGW("Line not terminated by \\r\\n. FID=%d", _socket);
+        raiseError(400, "Bad Request");
+        return false;
+      }
+      return true;
     }
   }
+  return false;
+}
+
+/**
+ * Finds method, target and version in the request line, which has the given length (without \r\n)
+ */
+bool HTTPConnection::parseRequestLine(size_t lineLength) {
+  const char * line = _headBuffer + _lineStart;
+
+  // Find the method
+  const char * spaceAfterMethod = (const char*)memchr(line, ' ', lineLength);
+  if (spaceAfterMethod == NULL) {
+    HTTPS_LOGW("Missing space after method");
+    raiseError(400, "Bad Request");
+    return false;
+  }
+  _requestLine.methodLength = spaceAfterMethod - line;
+
+  // Find the resource string
+  _requestLine.targetOffset = _requestLine.methodLength + 1;
+  const char * spaceAfterTarget = (const char*)memchr(line + _requestLine.targetOffset, ' ',
+    lineLength - _requestLine.targetOffset);
+  if (spaceAfterTarget == NULL) {
+    HTTPS_LOGW("Missing space after resource");
+    raiseError(400, "Bad Request");
+    return false;
+  }
+  _requestLine.targetLength = spaceAfterTarget - line - _requestLine.targetOffset;
+
+  // The rest is the protocol version
+  _requestLine.versionOffset = _requestLine.targetOffset + _requestLine.targetLength + 1;
+  _requestLine.versionLength = lineLength - _requestLine.versionOffset;
+  return true;
+}
+
+/**
+ * Finds name and value of a header line with the given length (without \r\n)
+ */
+bool HTTPConnection::parseHeaderLine(size_t lineLength) {
+  const char * line = _headBuffer + _lineStart;
+
+  const char * colon = (const char*)memchr(line, ':', lineLength);
+  if (colon == NULL || colon == line) {
+    HTTPS_LOGW("Malformed request header. FID=%d", _socket);
+    raiseError(400, "Bad Request");
+    return false;
+  }
+  if (_headerCount >= HTTPS_REQUEST_MAX_HEADERS) {
+    HTTPS_LOGW("Too many request headers. FID=%d", _socket);
+    raiseError(431, "Request Header Fields Too Large");
+    return false;
+  }
+
+  // Optional whitespace around the value is not part of it
+  size_t valueStart = colon - line + 1;
+  size_t valueEnd = lineLength;
+  while (valueStart < valueEnd && (line[valueStart] == ' ' || line[valueStart] == '\t')) {
+    valueStart++;
+  }
+  while (valueEnd > valueStart && (line[valueEnd - 1] == ' ' || line[valueEnd - 1] == '\t')) {
+    valueEnd--;
+  }
+
+  _headerSlices[_headerCount].nameOffset = _lineStart;
+  _headerSlices[_headerCount].nameLength = colon - line;
+  _headerSlices[_headerCount].valueOffset = _lineStart + valueStart;
+  _headerSlices[_headerCount].valueLength = valueEnd - valueStart;
+  _headerCount++;
+  return true;
 }
 
 /**
@@ -342,7 +644,38 @@ size_t HTTPConnection::getCacheSize() {
   return (_isKeepAlive ? HTTPS_KEEPALIVE_CACHESIZE : 0);
 }
 
+/**
+ * Returns whether the response may use Transfer-Encoding: chunked, which requires an HTTP/1.1 client.
+ */
+bool HTTPConnection::supportsChunkedEncoding() {
+  return _isHttp11;
+}
+
+/**
+ * Advances the handshake of the connection, called by loop() as long as the connection is in
+ * STATE_HANDSHAKE. Plain HTTP connections have no handshake, subclasses override this.
+ */
+void HTTPConnection::handshake() {
+  _connectionState = STATE_INITIAL;
+}
+
 void HTTPConnection::loop() {
+  // The handshake has to be completed before any data can be read. It is advanced step by step
+  // whenever the socket is ready, so that other connections are served in the meantime.
+  if (_connectionState == STATE_HANDSHAKE) {
+    // The handshake reads from the socket on its own
+    _readReadyKnown = false;
+    handshake();
+    if (_connectionState == STATE_INITIAL) {
+      // The request gets the full timeout, regardless of how long the handshake took
+      refreshTimeout();
+    } else if (!isClosed() && isTimeoutExceeded()) {
+      HTTPS_LOGI("Handshake timeout. FID=%d", _socket);
+      closeConnection();
+    }
+    return;
+  }
+
   // First, update the buffer
   // newByteCount will contain the number of new bytes that have to be processed
   updateBuffer();
@@ -351,7 +684,7 @@ void HTTPConnection::loop() {
     HTTPS_LOGI("Client closed (FID=%d, cstate=%d)", _socket, _clientState);
   }
 
-  if (_clientState == CSTATE_CLOSED && _bufferProcessed == _bufferUnusedIdx && _connectionState < STATE_HEADERS_FINISHED) {
+  if (_clientState == CSTATE_CLOSED && _bufferFillSize == 0 && _connectionState < STATE_HEADERS_FINISHED) {
     closeConnection();
   }
 
@@ -364,28 +697,25 @@ void HTTPConnection::loop() {
     // State machine (Reading request, reading headers, ...)
     switch(_connectionState) {
     case STATE_INITIAL: // Read request line
-      readLine(HTTPS_REQUEST_MAX_REQUEST_LENGTH);
-      if (_parserLine.parsingFinished && !isClosed()) {
-        // Find the method
-        size_t spaceAfterMethodIdx = _parserLine.text.find(' ');
-        if (spaceAfterMethodIdx == std::string::npos) {
-          HTTPS_LOGW("Missing space after method");
-          raiseError(400, "Bad Request");
+      if (readLine(HTTPS_REQUEST_MAX_REQUEST_LENGTH) && !isClosed()) {
+        // Empty lines before the request line may be ignored (RFC 7230, 3.5)
+        if (_headLength == 2) {
+          resetParser();
           break;
         }
-        _httpMethod = _parserLine.text.substr(0, spaceAfterMethodIdx);
-
-        // Find the resource string:
-        size_t spaceAfterResourceIdx = _parserLine.text.find(' ', spaceAfterMethodIdx + 1);
-        if (spaceAfterResourceIdx == std::string::npos) {
-          HTTPS_LOGW("Missing space after resource");
-          raiseError(400, "Bad Request");
+        if (!parseRequestLine(_headLength - _lineStart - 2)) {
           break;
         }
-        _httpResource = _parserLine.text.substr(spaceAfterMethodIdx + 1, spaceAfterResourceIdx - _httpMethod.length() - 1);
 
-        _parserLine.parsingFinished = false;
-        _parserLine.text = "";
+        // Method and resource are needed to resolve the node. The strings keep their capacity for
+        // the next request on this connection.
+        _httpMethod.assign(_headBuffer, _requestLine.methodLength);
+        _httpResource.assign(_headBuffer + _requestLine.targetOffset, _requestLine.targetLength);
+        _isHttp11 = (_requestLine.versionLength == 8 &&
+          memcmp(_headBuffer + _requestLine.versionOffset, "HTTP/1.1", 8) == 0);
+
+        _lineStart = _headLength;
+        _requestStartTS = micros();
         HTTPS_LOGI("Request: %s %s (FID=%d)", _httpMethod.c_str(), _httpResource.c_str(), _socket);
         _connectionState = STATE_REQUEST_FINISHED;
       }
@@ -393,66 +723,51 @@ void HTTPConnection::loop() {
       break;
     case STATE_REQUEST_FINISHED: // Read headers
 
-      while (_bufferProcessed < _bufferUnusedIdx && !isClosed()) {
-        readLine(HTTPS_REQUEST_MAX_HEADER_LENGTH);
-        if (_parserLine.parsingFinished && _connectionState != STATE_ERROR) {
+      while (_bufferFillSize > 0 && !isClosed()) {
+        if (!readLine(HTTPS_REQUEST_MAX_HEADER_LENGTH)) {
+          // The line is incomplete, so wait for more data (or an error has been raised)
+          break;
+        }
 
-          if (_parserLine.text.empty()) {
-            HTTPS_LOGD("Headers finished, FID=%d", _socket);
-            _connectionState = STATE_HEADERS_FINISHED;
+        size_t lineLength = _headLength - _lineStart - 2;
+        if (lineLength == 0) {
+          HTTPS_LOGD("Headers finished, FID=%d", _socket);
 
-            // Break, so that the rest of the body does not get flushed through
-            _parserLine.parsingFinished = false;
-            _parserLine.text = "";
-            break;
-          } else {
-            int idxColon = _parserLine.text.find(':');
-            if ( (idxColon != std::string::npos) && (_parserLine.text[idxColon+1]==' ') ) {
-              _httpHeaders->set(new HTTPHeader(
-                  _parserLine.text.substr(0, idxColon),
-                  _parserLine.text.substr(idxColon+2)
-              ));
-              HTTPS_LOGD("Header: %s = %s (FID=%d)", _parserLine.text.substr(0, idxColon).c_str(), _parserLine.text.substr(idxColon+2).c_str(), _socket);
-            } else {
-              HTTPS_LOGW("Malformed request header: %s", _parserLine.text.c_str());
-              raiseError(400, "Bad Request");
-              break;
-            }
+          // Fill the header table from the positions that have been recorded
+          for(size_t i = 0; i < _headerCount; i++) {
+            _httpHeaders->set(
+              _headBuffer + _headerSlices[i].nameOffset, _headerSlices[i].nameLength,
+              _headBuffer + _headerSlices[i].valueOffset, _headerSlices[i].valueLength
+            );
           }
+          _connectionState = STATE_HEADERS_FINISHED;
+
+          // Break, so that the rest of the body does not get flushed through
+          break;
+        }
 
-          _parserLine.parsingFinished = false;
-          _parserLine.text = "";
+        if (!parseHeaderLine(lineLength)) {
+          break;
         }
+        _lineStart = _headLength;
       }
 
       break;
     case STATE_HEADERS_FINISHED: // Handle body
       {
         HTTPS_LOGD("Resolving resource...");
-        ResolvedResource resolvedResource;
 
         // Check which kind of node we need (Websocket or regular)
         bool websocketRequested = checkWebsocket();
 
-        _resResolver->resolveNode(_httpMethod, _httpResource, resolvedResource, websocketRequested ? WEBSOCKET : HANDLER_CALLBACK);
+        _resResolver->resolveNode(_httpMethod, _httpResource, _resolvedResource, websocketRequested ? WEBSOCKET : HANDLER_CALLBACK);
 
         // Is there any match (may be the defaultNode, if it is configured)
-        if (resolvedResource.didMatch()) {
+        if (_resolvedResource.didMatch()) {
           // Check for client's request to keep-alive if we have a handler function.
-          if (resolvedResource.getMatchingNode()->_nodeType == HANDLER_CALLBACK) {
+          if (_resolvedResource.getMatchingNode()->_nodeType == HANDLER_CALLBACK) {
             // Did the client set connection:keep-alive?
-            HTTPHeader * connectionHeader = _httpHeaders->get("Connection");
-            std::string connectionHeaderValue = "";
-            if (connectionHeader != NULL) {
-              connectionHeaderValue += connectionHeader->_value;
-              std::transform(
-                connectionHeaderValue.begin(),
-                connectionHeaderValue.end(),
-                connectionHeaderValue.begin(),
-                [](unsigned char c){ return ::tolower(c); }
-              );
-            }
-            if (std::string("keep-alive").compare(connectionHeaderValue)==0) {
+            if (_httpHeaders->valueEquals(HEADER_CONNECTION, "keep-alive")) {
               HTTPS_LOGD("Keep-Alive activated. FID=%d", _socket);
               _isKeepAlive = true;
             } else {
@@ -467,17 +782,20 @@ void HTTPConnection::loop() {
           HTTPRequest req  = HTTPRequest(
             this,
             _httpHeaders,
-            resolvedResource.getMatchingNode(),
+            _resolvedResource.getMatchingNode(),
             _httpMethod,
-            resolvedResource.getParams(),
+            _resolvedResource.getParams(),
             _httpResource
           );
-          HTTPResponse res = HTTPResponse(this);
+          if (getCacheSize() > 0 && _responseCache == NULL) {
+            _responseCache = new byte[getCacheSize()];
+          }
+          HTTPResponse res = HTTPResponse(this, _responseHeaders, _responseCache);
 
           // Add default headers to the response
-          auto allDefaultHeaders = _defaultHeaders->getAll();
-          for(std::vector<HTTPHeader*>::iterator header = allDefaultHeaders->begin(); header != allDefaultHeaders->end(); ++header) {
-            res.setHeader((*header)->_name, (*header)->_value);
+          for(size_t i = 0; i < _defaultHeaders->size(); i++) {
+            HTTPHeaderRef header = _defaultHeaders->at(i);
+            res.getHTTPHeaders()->set(header.name, header.nameLength, header.value, header.valueLength);
           }
 
           // Find the request handler callback
@@ -487,27 +805,18 @@ void HTTPConnection::loop() {
             resourceCallback = &handleWebsocketHandshake;
           } else {
             // For resource nodes, we use the callback defined by the node itself
-            resourceCallback = ((ResourceNode*)resolvedResource.getMatchingNode())->_callback;
+            resourceCallback = ((ResourceNode*)_resolvedResource.getMatchingNode())->_callback;
           }
 
-          // Get the current middleware chain
-          auto vecMw = _resResolver->getMiddleware();
-
-          // Anchor of the chain is the actual resource. The call to the handler is bound here
-          std::function<void()> next = std::function<void()>(std::bind(resourceCallback, &req, &res));
-
-          // Go back in the middleware chain and glue everything together
-          auto itMw = vecMw.rbegin();
-          while(itMw != vecMw.rend()) {
-            next = std::function<void()>(std::bind((*itMw), &req, &res, next));
-            itMw++;
-          }
-
-          // We insert the internal validation middleware at the start of the chain:
-          next = std::function<void()>(std::bind(&validationMiddleware, &req, &res, next));
-
-          // Call the whole chain
-          next();
+          // Run the validation, the global middleware, the middleware of the node and finally
+          // the actual resource. The chain lives on the stack, so nothing is allocated for it
+          MiddlewareChain chain;
+          chain.req = &req;
+          chain.res = &res;
+          chain.globalMiddleware = &_resResolver->getMiddleware();
+          chain.nodeMiddleware = websocketRequested ? NULL : &((ResourceNode*)_resolvedResource.getMatchingNode())->getMiddleware();
+          chain.callback = resourceCallback;
+          chain.run(0);
 
           // The callback-function should have read all of the request body.
           // However, if it does not, we need to clear the request body now,
@@ -515,11 +824,16 @@ void HTTPConnection::loop() {
           if (!req.requestComplete()) {
             HTTPS_LOGW("Callback function did not parse full request body");
             req.discardRequestBody();
+            // The rest of the body must not be taken for the next request
+            if (!req.requestComplete()) {
+              _isKeepAlive = false;
+            }
           }
 
           // Finally, after the handshake is done, we create the WebsocketHandler and change the internal state.
           if(websocketRequested) {
-            _wsHandler = ((WebsocketNode*)resolvedResource.getMatchingNode())->newHandler();
+            flushOutput();
+            _wsHandler = ((WebsocketNode*)_resolvedResource.getMatchingNode())->newHandler();
             _wsHandler->initialize(this);  // make websocket with this connection 
             _connectionState = STATE_WEBSOCKET;
           } else {
@@ -530,31 +844,35 @@ void HTTPConnection::loop() {
             // However, if the client did not set content-size or defined connection: close,
             // we have no chance to do so.
             // Also, the programmer may have explicitly set Connection: close for the response.
-            std::string hConnection = res.getHeader("Connection");
-            if (hConnection == "close") {
+            if (res.getHTTPHeaders()->valueEquals(HEADER_CONNECTION, "close")) {
               _isKeepAlive = false;
             }
             if (!_isKeepAlive) {
               // No KeepAlive -> We are done. Transition to next state.
               if (!isClosed()) {
                 res.finalize();
+                flushOutput();
+                HTTPS_LOGI("Response sent %lu us after the request line. FID=%d", micros() - _requestStartTS, _socket);
                 _connectionState = STATE_BODY_FINISHED;
               }
             } else {
-              if (res.isResponseBuffered()) {
-                // If the response could be buffered:
-                res.setHeader("Connection", "keep-alive");
+              if (res.isKeepAlivePossible()) {
+                // If the response could be buffered or is sent with chunked encoding:
+                res.getHTTPHeaders()->set(HEADER_CONNECTION, "keep-alive");
                 res.finalize();
+                flushOutput();
+                HTTPS_LOGI("Response sent %lu us after the request line. FID=%d", micros() - _requestStartTS, _socket);
                 if (_clientState != CSTATE_CLOSED) {
                   // Refresh the timeout for the new request
                   refreshTimeout();
                   // Reset headers for the new connection
                   _httpHeaders->clearAll();
+                  resetParser();
                   // Go back to initial state
                   _connectionState = STATE_INITIAL;
                 }
               }
-              // The response could not be buffered or the client has closed:
+              // The length of the response is unknown or the client has closed:
               if (!isClosed() && _connectionState!=STATE_INITIAL) {
                 _connectionState = STATE_BODY_FINISHED;
               }
@@ -592,7 +910,7 @@ void HTTPConnection::loop() {
         HTTPS_LOGI("WS closed, freeing Handler, FID=%d", _socket);
         delete _wsHandler;
         _wsHandler = nullptr;
-        _connectionState = STATE_CLOSING;
+        closeConnection();
       }
       break;
     default:;
@@ -604,11 +922,11 @@ void HTTPConnection::loop() {
 
 bool HTTPConnection::checkWebsocket() {
   if(_httpMethod == "GET" &&
-     !_httpHeaders->getValue("Host").empty() &&
-      _httpHeaders->getValue("Upgrade") == "websocket" &&
-      _httpHeaders->getValue("Connection").find("Upgrade") != std::string::npos &&
-     !_httpHeaders->getValue("Sec-WebSocket-Key").empty() &&
-      _httpHeaders->getValue("Sec-WebSocket-Version") == "13") {
+      _httpHeaders->has(HEADER_HOST) &&
+      _httpHeaders->valueEquals(HEADER_UPGRADE, "websocket") &&
+      _httpHeaders->valueContains(HEADER_CONNECTION, "Upgrade") &&
+      _httpHeaders->has(HEADER_SEC_WEBSOCKET_KEY) &&
+      _httpHeaders->valueEquals(HEADER_SEC_WEBSOCKET_VERSION, "13")) {
 
       HTTPS_LOGI("Upgrading to WS, FID=%d", _socket);
       return true;
@@ -616,6 +934,31 @@ bool HTTPConnection::checkWebsocket() {
       return false;
 }
 
+/**
+ * Calls the step with the given index. Step 0 is the validation middleware, followed by the global
+ * middleware functions, those of the node and the resource callback.
+ */
+void MiddlewareChain::run(size_t step) {
+  // The functor consists of two words, so std::function stores it without allocating memory
+  std::function<void()> next = MiddlewareNext(this, step + 1);
+  if (step == 0) {
+    validationMiddleware(req, res, next);
+    return;
+  }
+  step -= 1;
+  if (step < globalMiddleware->size()) {
+    (*globalMiddleware)[step](req, res, next);
+    return;
+  }
+  step -= globalMiddleware->size();
+  size_t nodeMiddlewareCount = nodeMiddleware == NULL ? 0 : nodeMiddleware->size();
+  if (step < nodeMiddlewareCount) {
+    (*nodeMiddleware)[step](req, res, next);
+  } else if (step == nodeMiddlewareCount) {
+    callback(req, res);
+  }
+}
+
 /**
  * Middleware function that handles the validation of parameters
  */
@@ -652,9 +995,10 @@ void validationMiddleware(HTTPRequest * req, HTTPResponse * res, std::function<v
 void handleWebsocketHandshake(HTTPRequest * req, HTTPResponse * res) {
   res->setStatusCode(101);
   res->setStatusText("Switching Protocols");
-  res->setHeader("Upgrade", "websocket");
-  res->setHeader("Connection", "Upgrade");
-  res->setHeader("Sec-WebSocket-Accept", websocketKeyResponseHash(req->getHeader("Sec-WebSocket-Key")));
+  HTTPHeaders * headers = res->getHTTPHeaders();
+  headers->set(HEADER_UPGRADE, "websocket");
+  headers->set(HEADER_CONNECTION, "Upgrade");
+  headers->set(HEADER_SEC_WEBSOCKET_ACCEPT, websocketKeyResponseHash(req->getHTTPHeaders()->getValue(HEADER_SEC_WEBSOCKET_KEY)));
   res->print("");
 }
 
@@ -5,6 +5,7 @@
 #include <IPAddress.h>
 
 #include <string>
+#include <climits>
 #include <mbedtls/base64.h>
 #include <esp32/sha.h>
 #include <functional>
@@ -13,6 +14,7 @@
 #include "lwip/netdb.h"
 #undef read
 #include "lwip/sockets.h"
+#include <errno.h>
 
 #include "HTTPSServerConstants.hpp"
 #include "ConnectionContext.hpp"
@@ -42,29 +44,48 @@ public:
 
   virtual int initialize(int serverSocketID, HTTPHeaders *defaultHeaders);
   virtual void closeConnection();
+  virtual void reset();
   virtual bool isSecure();
   virtual IPAddress getClientIP();
 
   void loop();
   bool isClosed();
   bool isError();
+  bool isFree();
+
+  int getSocket();
+  void setReadReady(bool readReady);
+  bool hasPendingWork();
+  bool isIdleKeepAlive();
+  unsigned long getIdleMillis();
+  unsigned long getMillisUntilTimeout();
+  virtual bool wantsWrite();
 
 protected:
   friend class HTTPRequest;
   friend class HTTPResponse;
   friend class WebsocketInputStreambuf;
 
-  virtual size_t writeBuffer(byte* buffer, size_t length);
+  virtual size_t writeBytesFromBuffer(byte* buffer, size_t length);
+  using ConnectionContext::flushOutput;
   virtual size_t readBytesToBuffer(byte* buffer, size_t length);
+  virtual void handshake();
   virtual bool canReadData();
   virtual size_t pendingByteCount();
 
   // Timestamp of the last transmission action
   unsigned long _lastTransmissionTS;
 
+  // Time (in us) at which the request line of the current request has been read
+  unsigned long _requestStartTS;
+
   // Timestamp of when the shutdown was started
   unsigned long _shutdownTS;
 
+  // Result of the server's select() call for this connection, see setReadReady()
+  bool _readReadyKnown;
+  bool _readReady;
+
   // Internal state machine of the connection:
   //
   // O --- > STATE_UNDEFINED -- initialize() --> STATE_INITIAL -- get / http/1.1 --> STATE_REQUEST_FINISHED --.
@@ -79,11 +100,16 @@ protected:
   //  ^                                    |        |                                       |                 |
   //  `---------- close() ---------- STATE_BODY_FINISHED <-- Body received or GET -- STATE_HEADERS_FINISHED <-´
   //
+  // For TLS connections, initialize() leads to STATE_HANDSHAKE instead, and loop() moves on to STATE_INITIAL
+  // as soon as the handshake has been completed.
+  //
   enum {
     // The order is important, to be able to use state <= STATE_HEADERS_FINISHED etc.
 
     // The connection has not been established yet
     STATE_UNDEFINED,
+    // The TLS handshake is in progress (HTTPSConnection only)
+    STATE_HANDSHAKE,
     // The connection has just been created
     STATE_INITIAL,
     // The request line has been parsed
@@ -110,27 +136,35 @@ protected:
 
 private:
   void raiseError(uint16_t code, std::string reason);
-  void readLine(int lengthLimit);
+  bool readLine(size_t lengthLimit);
+  void resetParser();
+  bool parseRequestLine(size_t lineLength);
+  bool parseHeaderLine(size_t lineLength);
 
   bool isTimeoutExceeded();
   void refreshTimeout();
 
   int updateBuffer();
   size_t pendingBufferSize();
+  bool waitForData(unsigned long timeoutMs);
+  bool isClientClosed();
 
   void signalClientClose();
   void signalRequestError();
   size_t readBuffer(byte* buffer, size_t length);
+  size_t peekBuffer(const byte ** data);
+  void consumeBuffer(size_t length);
   size_t getCacheSize();
+  bool supportsChunkedEncoding();
   bool checkWebsocket();
 
-  // The receive buffer
+  // The receive buffer, used as ring buffer
   char _receiveBuffer[HTTPS_CONNECTION_DATA_CHUNK_SIZE];
 
-  // First index on _receive_buffer that has not been processed yet (anything before may be discarded)
-  int _bufferProcessed;
-  // The index on the receive_buffer that is the first one which is empty at the end.
-  int _bufferUnusedIdx;
+  // Index on _receiveBuffer of the first byte that has not been processed yet
+  size_t _bufferReadIdx;
+  // Number of unprocessed bytes in _receiveBuffer, starting at _bufferReadIdx (may wrap around)
+  size_t _bufferFillSize;
 
   // Socket address, length etc for the connection
   struct sockaddr _sockAddr;
@@ -140,23 +174,56 @@ private:
   // Resource resolver used to resolve resources
   ResourceResolver * _resResolver;
 
-  // The parser line. The struct is used to read the next line up to the \r\n in readLine()
+  // The request head (request line and headers). readLine() moves the lines from the receive buffer
+  // to this buffer, where they are parsed in place
+  char _headBuffer[HTTPS_REQUEST_MAX_HEAD_SIZE];
+  // Number of bytes in _headBuffer
+  size_t _headLength;
+  // Offset of the line in _headBuffer that is currently read
+  size_t _lineStart;
+
+  // Positions of the parts of the request line in _headBuffer
   struct {
-    std::string text = "";
-    bool parsingFinished = false;
-  } _parserLine;
+    uint16_t methodLength;
+    uint16_t targetOffset;
+    uint16_t targetLength;
+    uint16_t versionOffset;
+    uint16_t versionLength;
+  } _requestLine;
+
+  // Positions of the header names and values in _headBuffer
+  struct {
+    uint16_t nameOffset;
+    uint16_t nameLength;
+    uint16_t valueOffset;
+    uint16_t valueLength;
+  } _headerSlices[HTTPS_REQUEST_MAX_HEADERS];
+  size_t _headerCount;
 
   // HTTP properties: Method, Request, Headers
   std::string _httpMethod;
   std::string _httpResource;
   HTTPHeaders * _httpHeaders;
 
+  // Result of resolving the request, reused for every request. resolveNode() resets it
+  ResolvedResource _resolvedResource;
+
+  // Headers of the response, which are cleared and reused for every response
+  HTTPHeaders * _responseHeaders;
+
+  // Cache for buffered responses with HTTPS_KEEPALIVE_CACHESIZE bytes. It is allocated for the first
+  // keep-alive request and kept for the lifetime of the connection object
+  byte * _responseCache;
+
   // Default headers that are applied to every response
   HTTPHeaders * _defaultHeaders;
 
   // Should we use keep alive
   bool _isKeepAlive;
 
+  // Did the client send an HTTP/1.1 request (and may thus receive chunked responses)?
+  bool _isHttp11;
+
   //Websocket connection
   WebsocketHandler * _wsHandler;
 
@@ -168,6 +235,33 @@ std::string websocketKeyResponseHash(std::string const &key);
 
 void validationMiddleware(HTTPRequest * req, HTTPResponse * res, std::function<void()> next);
 
+/**
+ * \brief Middleware chain of a single request
+ *
+ * The chain is not built from nested std::functions. Instead, each next() that is passed to a
+ * middleware function only stores the chain and the index of the following step.
+ */
+struct MiddlewareChain {
+  HTTPRequest * req;
+  HTTPResponse * res;
+  const std::vector<const HTTPSMiddlewareFunction*> * globalMiddleware;
+  const std::vector<const HTTPSMiddlewareFunction*> * nodeMiddleware;
+  HTTPSCallbackFunction * callback;
+
+  void run(size_t step);
+};
+
+/**
+ * \brief The next() function for a step of a MiddlewareChain
+ */
+struct MiddlewareNext {
+  MiddlewareNext(MiddlewareChain * chain, size_t step): _chain(chain), _step(step) {}
+  void operator()() const { _chain->run(_step); }
+
+  MiddlewareChain * _chain;
+  size_t _step;
+};
+
 } /* namespace httpsserver */
 
 #endif /* SRC_HTTPCONNECTION_HPP_ */
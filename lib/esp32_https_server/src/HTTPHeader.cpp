@@ -1,43 +1,134 @@
 #include "HTTPHeader.hpp"
 
-#include <locale>
-#include <ostream>
-#include <sstream>
-
 namespace httpsserver {
 
-HTTPHeader::HTTPHeader(const std::string &name, const std::string &value):
-  _name(normalizeHeaderName(name)),
-  _value(value) {
-    
+// Canonical spelling of the known headers, in the order of HTTPHeaderId
+static const char * const HEADER_NAMES[HEADER_COUNT] = {
+  "Accept",
+  "Accept-Encoding",
+  "Accept-Ranges",
+  "Authorization",
+  "Cache-Control",
+  "Connection",
+  "Content-Encoding",
+  "Content-Length",
+  "Content-Range",
+  "Content-Type",
+  "Cookie",
+  "Date",
+  "ETag",
+  "Expect",
+  "Host",
+  "If-Modified-Since",
+  "If-None-Match",
+  "If-Range",
+  "Keep-Alive",
+  "Last-Modified",
+  "Location",
+  "Origin",
+  "Range",
+  "Retry-After",
+  "Sec-WebSocket-Accept",
+  "Sec-WebSocket-Key",
+  "Sec-WebSocket-Version",
+  "Server",
+  "Transfer-Encoding",
+  "Upgrade",
+  "User-Agent",
+  "Vary",
+  "WWW-Authenticate",
+};
+
+/**
+ * Perfect hash table for the names in HEADER_NAMES. The slot of a name is
+ *
+ *   (first + 3 * last + 56 * length) % 128
+ *
+ * with first and last being the outermost characters, OR'ed with 0x20 to ignore their case. No two
+ * known names share a slot, so a lookup needs a single comparison. The table has to be regenerated
+ * if a header is added to HTTPHeaderId.
+ */
+#define NA 0xFF
+static const uint8_t HEADER_SLOTS[128] = {
+  NA, 30, NA,  3, NA, NA, NA, NA, NA, 21, NA, NA, NA,  0, NA, NA,
+  NA, 13,  2, NA, NA, NA, 25, NA,  6, 27, NA, NA, NA, NA, NA, NA,
+  NA, NA, NA, NA, 14, NA, 32, NA, NA, NA, NA,  7, 29, NA, NA, 24,
+  23, NA,  9, NA, NA, NA, NA, NA, NA, 22, NA, NA, NA, NA, NA, NA,
+  NA, 31, NA, NA, NA, NA, NA, NA, NA, NA, 18, NA, NA, NA, NA, NA,
+  15, NA, NA, NA, NA, 26, NA, NA, 17, NA, NA, NA, NA,  5,  1, NA,
+  NA, 28, 10, NA, NA, NA, NA, NA, NA, NA,  8, NA, NA, NA, NA, NA,
+  19, NA, NA, 11, NA, NA, 20, NA, NA, 16, 12, NA, NA, NA, NA,  4,
+};
+#undef NA
+
+static inline char asciiToLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static inline char asciiToUpper(char c) {
+  return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
 }
 
-HTTPHeader::~HTTPHeader() {
+static inline bool isAsciiAlnum(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
 
+/**
+ * Returns the identifier of a known header, or HEADER_UNKNOWN. The name is not case-sensitive.
+ */
+HTTPHeaderId lookupHeaderId(const char * name, size_t length) {
+  if (length == 0) {
+    return HEADER_UNKNOWN;
+  }
+  uint8_t first = name[0] | 0x20;
+  uint8_t last = name[length - 1] | 0x20;
+  uint8_t id = HEADER_SLOTS[(first + 3 * last + 56 * length) & 127];
+  if (id < HEADER_COUNT && strlen(HEADER_NAMES[id]) == length && equalsIgnoreCase(HEADER_NAMES[id], name, length)) {
+    return (HTTPHeaderId)id;
+  }
+  return HEADER_UNKNOWN;
 }
 
-std::string HTTPHeader::print() {
-  return _name + ": " + _value;
+/**
+ * Returns the canonical name of a known header
+ */
+const char * getHeaderName(HTTPHeaderId id) {
+  return id < HEADER_COUNT ? HEADER_NAMES[id] : "";
+}
+
+/**
+ * Compares two strings of the given length, ignoring the case of ASCII letters
+ */
+bool equalsIgnoreCase(const char * a, const char * b, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    if (a[i] != b[i] && asciiToLower(a[i]) != asciiToLower(b[i])) {
+      return false;
+    }
+  }
+  return true;
 }
 
 std::string normalizeHeaderName(std::string const &name) {
-  std::locale loc;
-  std::stringbuf buf;
-  std::ostream oBuf(&buf);
+  std::string normalized = name;
+  if (!normalized.empty()) {
+    normalizeHeaderName(&normalized[0], normalized.length());
+  }
+  return normalized;
+}
+
+void normalizeHeaderName(char * name, size_t length) {
   bool upper = true;
-  std::string::size_type len = name.length();
-  for (std::string::size_type i = 0; i < len; ++i) {
+  for (size_t i = 0; i < length; ++i) {
     if (upper) {
-      oBuf << std::toupper(name[i], loc);
+      name[i] = asciiToUpper(name[i]);
       upper = false;
     } else {
-      oBuf << std::tolower(name[i], loc);
-      if (!std::isalnum(name[i], loc)) {
-        upper=true;
+      if (!isAsciiAlnum(name[i])) {
+        upper = true;
       }
+      name[i] = asciiToLower(name[i]);
     }
   }
-  return buf.str();
 }
 
 } /* namespace httpsserver */
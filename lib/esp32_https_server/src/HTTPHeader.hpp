@@ -7,17 +7,56 @@
 namespace httpsserver {
 
 /**
- * \brief Represents a single name/value pair of an HTTP header
+ * \brief Headers that are known to the server
+ *
+ * Names of known headers are mapped to these identifiers once when they are stored, so that
+ * HTTPHeaders can look them up by index instead of comparing names.
  */
-class HTTPHeader {
-public:
-  HTTPHeader(const std::string &name, const std::string &value);
-  virtual ~HTTPHeader();
-  const std::string _name;
-  const std::string _value;
-  std::string print();
+enum HTTPHeaderId {
+  HEADER_ACCEPT,
+  HEADER_ACCEPT_ENCODING,
+  HEADER_ACCEPT_RANGES,
+  HEADER_AUTHORIZATION,
+  HEADER_CACHE_CONTROL,
+  HEADER_CONNECTION,
+  HEADER_CONTENT_ENCODING,
+  HEADER_CONTENT_LENGTH,
+  HEADER_CONTENT_RANGE,
+  HEADER_CONTENT_TYPE,
+  HEADER_COOKIE,
+  HEADER_DATE,
+  HEADER_ETAG,
+  HEADER_EXPECT,
+  HEADER_HOST,
+  HEADER_IF_MODIFIED_SINCE,
+  HEADER_IF_NONE_MATCH,
+  HEADER_IF_RANGE,
+  HEADER_KEEP_ALIVE,
+  HEADER_LAST_MODIFIED,
+  HEADER_LOCATION,
+  HEADER_ORIGIN,
+  HEADER_RANGE,
+  HEADER_RETRY_AFTER,
+  HEADER_SEC_WEBSOCKET_ACCEPT,
+  HEADER_SEC_WEBSOCKET_KEY,
+  HEADER_SEC_WEBSOCKET_VERSION,
+  HEADER_SERVER,
+  HEADER_TRANSFER_ENCODING,
+  HEADER_UPGRADE,
+  HEADER_USER_AGENT,
+  HEADER_VARY,
+  HEADER_WWW_AUTHENTICATE,
+  // Number of known headers
+  HEADER_COUNT,
+  // Used for all other headers
+  HEADER_UNKNOWN = HEADER_COUNT
 };
 
+HTTPHeaderId lookupHeaderId(const char * name, size_t length);
+const char * getHeaderName(HTTPHeaderId id);
+
+bool equalsIgnoreCase(const char * a, const char * b, size_t length);
+
 /**
  * \brief Normalizes case in header names
  * 
@@ -27,6 +66,11 @@ public:
  */
 std::string normalizeHeaderName(std::string const &name);
 
+/**
+ * \brief Normalizes case in a header name, without copying it
+ */
+void normalizeHeaderName(char * name, size_t length);
+
 } /* namespace httpsserver */
 
 #endif /* SRC_HTTPHEADER_HPP_ */
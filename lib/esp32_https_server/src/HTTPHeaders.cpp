@@ -3,59 +3,273 @@
 namespace httpsserver {
 
 HTTPHeaders::HTTPHeaders() {
-  _headers = new std::vector<HTTPHeader *>();
-
+  _arena = NULL;
+  _arenaSize = 0;
+  _arenaLength = 0;
+  _entries = NULL;
+  _entryCapacity = 0;
+  _entryCount = 0;
+  memset(_knownEntries, -1, sizeof(_knownEntries));
 }
 
 HTTPHeaders::~HTTPHeaders() {
-  clearAll();
-  delete _headers;
+  delete[] _arena;
+  delete[] _entries;
+}
+
+/**
+ * Returns true if a header with the given name exists. The name is not case-sensitive.
+ */
+bool HTTPHeaders::has(std::string const &name) {
+  return find(name.data(), name.length()) >= 0;
+}
+
+/**
+ * Returns true if the known header exists
+ */
+bool HTTPHeaders::has(HTTPHeaderId id) {
+  return id < HEADER_COUNT && _knownEntries[id] >= 0;
+}
+
+/**
+ * Returns the value of the header with the given name, or an empty string if there is no such header
+ */
+std::string HTTPHeaders::getValue(std::string const &name) {
+  int idx = find(name.data(), name.length());
+  if (idx < 0) {
+    return "";
+  }
+  return std::string(_arena + _entries[idx].valueOffset, _entries[idx].valueLength);
+}
+
+/**
+ * Returns the value of the known header, or an empty string if it does not exist
+ */
+std::string HTTPHeaders::getValue(HTTPHeaderId id) {
+  if (!has(id)) {
+    return "";
+  }
+  Entry &entry = _entries[_knownEntries[id]];
+  return std::string(_arena + entry.valueOffset, entry.valueLength);
 }
 
-HTTPHeader * HTTPHeaders::get(std::string const &name) {
-  std::string normalizedName = normalizeHeaderName(name);
-  for(std::vector<HTTPHeader*>::iterator header = _headers->begin(); header != _headers->end(); ++header) {
-    if ((*header)->_name.compare(normalizedName)==0) {
-      return (*header);
+/**
+ * Returns true if the value of the known header equals the given value, ignoring case
+ */
+bool HTTPHeaders::valueEquals(HTTPHeaderId id, const char * value) {
+  if (!has(id)) {
+    return false;
+  }
+  Entry &entry = _entries[_knownEntries[id]];
+  return entry.valueLength == strlen(value) && equalsIgnoreCase(_arena + entry.valueOffset, value, entry.valueLength);
+}
+
+/**
+ * Checks the parameters of a list element, like ";q=0.000", for a weight of zero
+ */
+static bool isZeroWeight(const char * params, size_t length) {
+  for(size_t i = 0; i + 2 < length; i++) {
+    if ((params[i] == 'q' || params[i] == 'Q') && params[i + 1] == '=' && params[i + 2] == '0') {
+      // The weight has up to three decimals
+      for(i += 3; i < length && (params[i] == '.' || params[i] == '0'); i++);
+      return i == length || params[i] == ';' || params[i] == ' ' || params[i] == '\t';
     }
   }
-  return NULL;
+  return false;
 }
 
-std::string HTTPHeaders::getValue(std::string const &name) {
-  std::string normalizedName = normalizeHeaderName(name);
-  for(std::vector<HTTPHeader*>::iterator header = _headers->begin(); header != _headers->end(); ++header) {
-    if ((*header)->_name.compare(normalizedName)==0) {
-      return ((*header)->_value);
+/**
+ * Returns true if the given token is an element of the comma-separated value of the known header,
+ * like "Connection: keep-alive, Upgrade". The comparison ignores case. Parameters of an element
+ * are skipped, but an element with the weight q=0 counts as refused ("Accept-Encoding: gzip;q=0").
+ */
+bool HTTPHeaders::valueContains(HTTPHeaderId id, const char * token) {
+  if (!has(id)) {
+    return false;
+  }
+  Entry &entry = _entries[_knownEntries[id]];
+  const char * value = _arena + entry.valueOffset;
+  size_t tokenLength = strlen(token);
+  size_t pos = 0;
+  while (pos < entry.valueLength) {
+    // Skip separators and whitespace in front of the element
+    while (pos < entry.valueLength && (value[pos] == ',' || value[pos] == ' ' || value[pos] == '\t')) {
+      pos++;
+    }
+    size_t start = pos;
+    while (pos < entry.valueLength && value[pos] != ',') {
+      pos++;
+    }
+    size_t end = start;
+    while (end < pos && value[end] != ';') {
+      end++;
+    }
+    size_t paramStart = end;
+    while (end > start && (value[end - 1] == ' ' || value[end - 1] == '\t')) {
+      end--;
+    }
+    if (end - start == tokenLength && equalsIgnoreCase(value + start, token, tokenLength)) {
+      return !isZeroWeight(value + paramStart, pos - paramStart);
     }
   }
-  return "";
+  return false;
+}
+
+void HTTPHeaders::set(std::string const &name, std::string const &value) {
+  set(name.data(), name.length(), value.data(), value.length());
+}
+
+/**
+ * Sets a known header, using its canonical name
+ */
+void HTTPHeaders::set(HTTPHeaderId id, std::string const &value) {
+  if (id < HEADER_COUNT) {
+    const char * name = getHeaderName(id);
+    set(id, name, strlen(name), value.data(), value.length());
+  }
 }
 
+/**
+ * Sets a header. If a header with the same name exists, its value is replaced.
+ */
+void HTTPHeaders::set(const char * name, size_t nameLength, const char * value, size_t valueLength) {
+  HTTPHeaderId id = lookupHeaderId(name, nameLength);
+  if (id < HEADER_COUNT) {
+    // Known headers are always stored with their canonical name
+    name = getHeaderName(id);
+  }
+  set(id, name, nameLength, value, valueLength);
+}
 
-void HTTPHeaders::set(HTTPHeader * header) {
-  for(int i = 0; i < _headers->size(); i++) {
-    if ((*_headers)[i]->_name.compare(header->_name)==0) {
-      delete (*_headers)[i];
-      (*_headers)[i] = header;
-      return;
+void HTTPHeaders::set(HTTPHeaderId id, const char * name, size_t nameLength, const char * value, size_t valueLength) {
+  int idx = (id < HEADER_COUNT) ? _knownEntries[id] : find(name, nameLength);
+  if (idx >= 0) {
+    Entry &entry = _entries[idx];
+    if (valueLength <= entry.valueLength) {
+      // The new value fits into the space of the old one
+      memcpy(_arena + entry.valueOffset, value, valueLength);
+    } else {
+      if (!reserve(_arenaLength + valueLength, _entryCount)) {
+        return;
+      }
+      entry.valueOffset = append(value, valueLength);
     }
+    entry.valueLength = valueLength;
+    return;
+  }
+
+  if (!reserve(_arenaLength + nameLength + valueLength, _entryCount + 1)) {
+    return;
+  }
+  if (id < HEADER_COUNT) {
+    _knownEntries[id] = _entryCount;
   }
-  _headers->push_back(header);
+  Entry &entry = _entries[_entryCount++];
+  entry.id = id;
+  entry.nameOffset = append(name, nameLength);
+  entry.nameLength = nameLength;
+  if (id == HEADER_UNKNOWN) {
+    normalizeHeaderName(_arena + entry.nameOffset, nameLength);
+  }
+  entry.valueOffset = append(value, valueLength);
+  entry.valueLength = valueLength;
+}
+
+/**
+ * Returns the number of headers
+ */
+size_t HTTPHeaders::size() {
+  return _entryCount;
 }
 
-std::vector<HTTPHeader *> * HTTPHeaders::getAll() {
-  return _headers;
+/**
+ * Returns the header at the given position, in the order in which they have been set
+ */
+HTTPHeaderRef HTTPHeaders::at(size_t idx) {
+  HTTPHeaderRef ref;
+  ref.name = _arena + _entries[idx].nameOffset;
+  ref.nameLength = _entries[idx].nameLength;
+  ref.value = _arena + _entries[idx].valueOffset;
+  ref.valueLength = _entries[idx].valueLength;
+  return ref;
 }
 
 /**
- * Deletes all headers
+ * Removes all headers. The memory is kept for the next use.
  */
 void HTTPHeaders::clearAll() {
-  for(std::vector<HTTPHeader*>::iterator header = _headers->begin(); header != _headers->end(); ++header) {
-    delete (*header);
+  _arenaLength = 0;
+  _entryCount = 0;
+  memset(_knownEntries, -1, sizeof(_knownEntries));
+}
+
+/**
+ * Returns the position of a header in _entries, or -1. Known headers are found through their
+ * identifier, only the others need to be compared by name.
+ */
+int HTTPHeaders::find(const char * name, size_t nameLength) {
+  HTTPHeaderId id = lookupHeaderId(name, nameLength);
+  if (id < HEADER_COUNT) {
+    return _knownEntries[id];
+  }
+  for(size_t i = 0; i < _entryCount; i++) {
+    Entry &entry = _entries[i];
+    if (entry.id == HEADER_UNKNOWN && entry.nameLength == nameLength &&
+        equalsIgnoreCase(_arena + entry.nameOffset, name, nameLength)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Copies data to the end of the arena, which must be large enough. Returns its offset.
+ */
+size_t HTTPHeaders::append(const char * data, size_t length) {
+  size_t offset = _arenaLength;
+  memcpy(_arena + offset, data, length);
+  _arenaLength += length;
+  return offset;
+}
+
+/**
+ * Makes sure that the arena and the header table have at least the given size. Both grow in steps
+ * of HTTPS_HEADERS_ARENA_SIZE bytes or HTTPS_HEADERS_TABLE_SIZE entries, respectively.
+ */
+bool HTTPHeaders::reserve(size_t arenaSize, size_t entryCount) {
+  if (arenaSize > _arenaSize) {
+    size_t newSize = _arenaSize + HTTPS_HEADERS_ARENA_SIZE;
+    while (newSize < arenaSize) {
+      newSize += HTTPS_HEADERS_ARENA_SIZE;
+    }
+    char * newArena = new char[newSize];
+    if (newArena == NULL) {
+      HTTPS_LOGE("Not enough memory for headers");
+      return false;
+    }
+    if (_arena != NULL) {
+      memcpy(newArena, _arena, _arenaLength);
+      delete[] _arena;
+    }
+    _arena = newArena;
+    _arenaSize = newSize;
+  }
+
+  if (entryCount > _entryCapacity) {
+    size_t newCapacity = _entryCapacity + HTTPS_HEADERS_TABLE_SIZE;
+    Entry * newEntries = new Entry[newCapacity];
+    if (newEntries == NULL) {
+      HTTPS_LOGE("Not enough memory for headers");
+      return false;
+    }
+    if (_entries != NULL) {
+      memcpy(newEntries, _entries, _entryCount * sizeof(Entry));
+      delete[] _entries;
+    }
+    _entries = newEntries;
+    _entryCapacity = newCapacity;
   }
-  _headers->clear();
+  return true;
 }
 
 } /* namespace httpsserver */
@@ -1,11 +1,8 @@
 #ifndef SRC_HTTPHEADERS_HPP_
 #define SRC_HTTPHEADERS_HPP_
 
+#include <Arduino.h>
 #include <string>
-// Arduino declares it's own min max, incompatible with the stl...
-#undef min
-#undef max
-#include <vector>
 
 #include "HTTPSServerConstants.hpp"
 #include "HTTPHeader.hpp"
@@ -13,23 +10,73 @@
 namespace httpsserver {
 
 /**
- * \brief Groups and manages a set of HTTPHeader instances
+ * \brief Name and value of a single header inside of HTTPHeaders
+ *
+ * The strings are not null-terminated. They are only valid until the HTTPHeaders are modified.
+ */
+struct HTTPHeaderRef {
+  const char * name;
+  size_t nameLength;
+  const char * value;
+  size_t valueLength;
+};
+
+/**
+ * \brief Groups and manages a set of HTTP headers
+ *
+ * All names and values are stored in a single byte arena, and the headers themselves in a flat
+ * table of positions in that arena. clearAll() only resets both, so an instance that is reused (like
+ * the request headers of a keep-alive connection) does not allocate memory once it has grown to
+ * the size of a typical request.
+ *
+ * Headers listed in HTTPHeaderId are recognized when they are set. They can be accessed by their
+ * identifier without comparing any names, which is what the server uses internally.
  */
 class HTTPHeaders {
 public:
   HTTPHeaders();
   virtual ~HTTPHeaders();
 
-  HTTPHeader * get(std::string const &name);
+  bool has(std::string const &name);
+  bool has(HTTPHeaderId id);
   std::string getValue(std::string const &name);
-  void set(HTTPHeader * header);
+  std::string getValue(HTTPHeaderId id);
+  bool valueEquals(HTTPHeaderId id, const char * value);
+  bool valueContains(HTTPHeaderId id, const char * token);
+  void set(std::string const &name, std::string const &value);
+  void set(HTTPHeaderId id, std::string const &value);
+  void set(const char * name, size_t nameLength, const char * value, size_t valueLength);
 
-  std::vector<HTTPHeader *> * getAll();
+  size_t size();
+  HTTPHeaderRef at(size_t idx);
 
   void clearAll();
 
 private:
-  std::vector<HTTPHeader*> * _headers;
+  int find(const char * name, size_t nameLength);
+  void set(HTTPHeaderId id, const char * name, size_t nameLength, const char * value, size_t valueLength);
+  size_t append(const char * data, size_t length);
+  bool reserve(size_t arenaSize, size_t entryCount);
+
+  // Storage for all names and values
+  char * _arena;
+  size_t _arenaSize;
+  size_t _arenaLength;
+
+  // The header table, with positions of the names and values in _arena
+  struct Entry {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+    HTTPHeaderId id;
+  };
+  Entry * _entries;
+  size_t _entryCapacity;
+  size_t _entryCount;
+
+  // Position of each known header in _entries, or -1
+  int16_t _knownEntries[HEADER_COUNT];
 };
 
 } /* namespace httpsserver */
@@ -6,9 +6,9 @@ HTTPRequest::HTTPRequest(
     ConnectionContext * con,
     HTTPHeaders * headers,
     HTTPNode * resolvedNode,
-    std::string method,
+    std::string const &method,
     ResourceParameters * params,
-    std::string requestString):
+    std::string const &requestString):
   _con(con),
   _headers(headers),
   _resolvedNode(resolvedNode),
@@ -16,12 +16,11 @@ HTTPRequest::HTTPRequest(
   _params(params),
   _requestString(requestString) {
 
-  HTTPHeader * contentLength = headers->get("Content-Length");
-  if (contentLength == NULL) {
+  if (!headers->has(HEADER_CONTENT_LENGTH)) {
     _remainingContent = 0;
     _contentLengthSet = false;
   } else {
-    _remainingContent = parseInt(contentLength->_value);
+    _remainingContent = parseInt(headers->getValue(HEADER_CONTENT_LENGTH));
     _contentLengthSet = true;
   }
 
@@ -41,16 +40,11 @@ HTTPHeaders * HTTPRequest::getHTTPHeaders() {
 }
 
 std::string HTTPRequest::getHeader(std::string const &name) {
-  HTTPHeader * h = _headers->get(name);
-  if (h != NULL) {
-    return h->_value;
-  } else {
-    return std::string();
-  }
+  return _headers->getValue(name);
 }
 
 void HTTPRequest::setHeader(std::string const &name, std::string const &value) {
-  _headers->set(new HTTPHeader(name, value));
+  _headers->set(name, value);
 }
 
 HTTPNode * HTTPRequest::getResolvedNode() {
@@ -80,6 +74,45 @@ size_t HTTPRequest::readBytes(byte * buffer, size_t length) {
   return bytesRead;
 }
 
+/**
+ * Provides a read-only view of the next part of the request body, without copying it out of
+ * the connection's receive buffer.
+ *
+ * data is set to the start of the view, the return value is its length (0 if no data is
+ * available right now). The view is limited to the request body and stays valid until the
+ * next call to any of the read, peek or consume functions. Use consumeBytes() to mark the
+ * data as processed, otherwise the next call will return the same data again.
+ */
+size_t HTTPRequest::peekBytes(const byte ** data) {
+  size_t length = 0;
+  if (!_contentLengthSet || _remainingContent > 0) {
+    length = _con->peekBuffer(data);
+  }
+
+  // Limit the view to content length
+  if (_contentLengthSet && length > _remainingContent) {
+    length = _remainingContent;
+  }
+
+  return length;
+}
+
+/**
+ * Marks length bytes of the request body as processed, usually after reading them using
+ * peekBytes().
+ */
+void HTTPRequest::consumeBytes(size_t length) {
+  if (_contentLengthSet && length > _remainingContent) {
+    length = _remainingContent;
+  }
+
+  _con->consumeBuffer(length);
+
+  if (_contentLengthSet) {
+    _remainingContent -= length;
+  }
+}
+
 size_t HTTPRequest::readChars(char * buffer, size_t length) {
   return readBytes((byte*)buffer, length);
 }
@@ -111,12 +144,33 @@ bool HTTPRequest::requestComplete() {
 }
 
 /**
- * This function will drop whatever is remaining of the request body
+ * Waits up to timeoutMs for the next part of the request body to arrive, without using the CPU in
+ * the meantime. Returns true if peekBytes() or readBytes() will return data.
+ */
+bool HTTPRequest::waitForData(unsigned long timeoutMs) {
+  return !requestComplete() && _con->waitForData(timeoutMs);
+}
+
+/**
+ * Returns true if the client has closed the connection. The part of the body that has already been
+ * received can still be read, but nothing more will arrive.
+ */
+bool HTTPRequest::isClientClosed() {
+  return _con->isClientClosed();
+}
+
+/**
+ * This function will drop whatever is remaining of the request body. It gives up if the client
+ * closes the connection or does not send anything for HTTPS_CONNECTION_TIMEOUT.
  */
 void HTTPRequest::discardRequestBody() {
-  byte buf[16];
+  const byte * data;
   while(!requestComplete()) {
-    readBytes(buf, 16);
+    size_t length = peekBytes(&data);
+    if (length == 0 && !waitForData(HTTPS_CONNECTION_TIMEOUT)) {
+      break;
+    }
+    consumeBytes(length);
   }
 }
 
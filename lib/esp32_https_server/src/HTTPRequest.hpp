@@ -21,7 +21,7 @@ namespace httpsserver {
  */
 class HTTPRequest {
 public:
-  HTTPRequest(ConnectionContext * con, HTTPHeaders * headers, HTTPNode * resolvedNode, std::string method, ResourceParameters * params, std::string requestString);
+  HTTPRequest(ConnectionContext * con, HTTPHeaders * headers, HTTPNode * resolvedNode, std::string const &method, ResourceParameters * params, std::string const &requestString);
   virtual ~HTTPRequest();
 
   std::string getHeader(std::string const &name);
@@ -34,8 +34,12 @@ public:
 
   size_t readChars(char * buffer, size_t length);
   size_t readBytes(byte * buffer, size_t length);
+  size_t peekBytes(const byte ** data);
+  void   consumeBytes(size_t length);
   size_t getContentLength();
   bool   requestComplete();
+  bool   waitForData(unsigned long timeoutMs);
+  bool   isClientClosed();
   void   discardRequestBody();
   ResourceParameters * getParams();
   HTTPHeaders *getHTTPHeaders();
@@ -53,11 +57,12 @@ private:
 
   HTTPNode * _resolvedNode;
 
-  std::string _method;
+  // Method and request string belong to the connection, which keeps them until the request is done
+  std::string const &_method;
 
   ResourceParameters * _params;
 
-  std::string _requestString;
+  std::string const &_requestString;
 
   bool _contentLengthSet;
   size_t _remainingContent;
@@ -5,31 +5,43 @@
 
 namespace httpsserver {
 
-HTTPResponse::HTTPResponse(ConnectionContext * con):
-  _con(con) {
+/**
+ * Creates a response on the given connection. The headers and the cache for buffered responses
+ * belong to the connection, which keeps them across keep-alive requests. The headers are cleared
+ * here. responseCache must hold con->getCacheSize() bytes, or be NULL for a non-buffered response.
+ */
+HTTPResponse::HTTPResponse(ConnectionContext * con, HTTPHeaders * headers, byte * responseCache):
+  _con(con),
+  _headers(headers) {
 
   // Default status code is 200 OK
   _statusCode = 200;
   _statusText = "OK";
   _headerWritten = false;
   _isError = false;
+  _isChunked = false;
+  _isLengthKnown = false;
+  _prerenderedHead = NULL;
+  _prerenderedHeadLength = 0;
+  _prerenderedBody = NULL;
+  _prerenderedBodyLength = 0;
+
+  _headers->clearAll();
 
-  _responseCacheSize = con->getCacheSize();
   _responseCachePointer = 0;
-  if (_responseCacheSize > 0) {
+  if (responseCache != NULL && con->getCacheSize() > 0) {
+    _responseCacheSize = con->getCacheSize();
     HTTPS_LOGD("Creating buffered response, size: %d", _responseCacheSize);
-    _responseCache = new byte[_responseCacheSize];
+    _responseCache = responseCache;
   } else {
     HTTPS_LOGD("Creating non-buffered response");
+    _responseCacheSize = 0;
     _responseCache = NULL;
   }
 }
 
 HTTPResponse::~HTTPResponse() {
-  if (_responseCache != NULL) {
-    delete[] _responseCache;
-  }
-  _headers.clearAll();
+  _headers->clearAll();
 }
 
 void HTTPResponse::setStatusCode(uint16_t statusCode) {
@@ -49,16 +61,15 @@ std::string HTTPResponse::getStatusText() {
 }
 
 void HTTPResponse::setHeader(std::string const &name, std::string const &value) {
-  _headers.set(new HTTPHeader(name, value));
+  _headers->set(name, value);
 }
 
 std::string HTTPResponse::getHeader(std::string const &name) {
-  HTTPHeader * h = _headers.get(name);
-  if (h != NULL) {
-    return h->_value;
-  } else {
-    return std::string();
-  }
+  return _headers->getValue(name);
+}
+
+HTTPHeaders * HTTPResponse::getHTTPHeaders() {
+  return _headers;
 }
 
 bool HTTPResponse::isHeaderWritten() {
@@ -69,9 +80,40 @@ bool HTTPResponse::isResponseBuffered() {
   return _responseCache != NULL;
 }
 
+/**
+ * Returns true if the client can find the end of the response without the connection being closed,
+ * because the response is still buffered, is sent in chunks or has an explicit Content-Length.
+ */
+bool HTTPResponse::isKeepAlivePossible() {
+  return isResponseBuffered() || _isChunked || _isLengthKnown;
+}
+
 void HTTPResponse::finalize() {
-  if (isResponseBuffered()) {
+  if (_prerenderedHead != NULL) {
+    printHeader();
+    if (!_isError && _prerenderedBodyLength > 0) {
+      _con->writeBuffer((byte*)_prerenderedBody, _prerenderedBodyLength);
+    }
+  } else if (isResponseBuffered()) {
     drainBuffer();
+  } else {
+    // The head has to be sent even if the handler did not write any data
+    printHeader();
+    if (_isChunked) {
+      // The last chunk has a length of 0
+      _con->writeBuffer((byte*)"0\r\n\r\n", 5);
+      _isChunked = false;
+    }
+  }
+}
+
+/**
+ * Sends all data that has been written to the response so far. Only required for responses that are
+ * streamed over a longer period of time, the server flushes when the response is complete.
+ */
+void HTTPResponse::flush() {
+  if (!isResponseBuffered()) {
+    _con->flushOutput();
   }
 }
 
@@ -82,10 +124,35 @@ void HTTPResponse::printStd(const std::string &str) {
   write((uint8_t*)str.c_str(), str.length());
 }
 
+/**
+ * Sends a response that has been rendered in advance, like an asset that is embedded at build time.
+ * head contains the status line and headers, including Content-Length, each terminated by CRLF but
+ * without the empty line that ends the head. The headers of this response, like the default headers
+ * of the server and Connection, are appended to it.
+ *
+ * Nothing is copied: head and body are written to the connection when the response is finalized,
+ * so they have to stay valid until then. Other data cannot be written to the response afterwards.
+ */
+void HTTPResponse::sendPrerendered(const char * head, size_t headLength, const uint8_t * body, size_t bodyLength) {
+  if (_headerWritten || _responseCachePointer > 0) {
+    HTTPS_LOGE("Cannot send a prerendered response, data has already been written");
+    return;
+  }
+  _prerenderedHead = head;
+  _prerenderedHeadLength = headLength;
+  _prerenderedBody = body;
+  _prerenderedBodyLength = bodyLength;
+  // The client finds the end of the response through the Content-Length in the head
+  _isLengthKnown = true;
+}
+
 /**
  * Writes bytes to the response. May be called several times.
  */
 size_t  HTTPResponse::write(const uint8_t *buffer, size_t size) {
+  if (_prerenderedHead != NULL) {
+    return 0;
+  }
   if(!isResponseBuffered()) {
     printHeader();
   }
@@ -96,6 +163,9 @@ size_t  HTTPResponse::write(const uint8_t *buffer, size_t size) {
  * Writes a single byte to the response.
  */
 size_t  HTTPResponse::write(uint8_t b) {
+  if (_prerenderedHead != NULL) {
+    return 0;
+  }
   if(!isResponseBuffered()) {
     printHeader();
   }
@@ -104,27 +174,46 @@ size_t  HTTPResponse::write(uint8_t b) {
 }
 
 /**
- *  If not already done, writes the header.
+ * If not already done, writes the response head. Its parts are written to the output buffer of the
+ * connection, which sends them together with the first part of the body.
  */
 void HTTPResponse::printHeader() {
   if (!_headerWritten) {
     HTTPS_LOGD("Printing headers");
 
-    // Status line, like: "HTTP/1.1 200 OK\r\n"
-    std::string statusLine = "HTTP/1.1 " + intToString(_statusCode) + " " + _statusText + "\r\n";
-    printInternal(statusLine, true);
+    if (!_isError) {
+      // Status line, like: "HTTP/1.1 200 OK\r\n". A prerendered head contains it already, together
+      // with the static headers
+      if (_prerenderedHead != NULL) {
+        _con->writeBuffer((byte*)_prerenderedHead, _prerenderedHeadLength);
+      } else {
+        std::string statusCode = intToString(_statusCode);
+        writeHead("HTTP/1.1 ", 9);
+        writeHead(statusCode.data(), statusCode.length());
+        writeHead(" ", 1);
+        writeHead(_statusText.data(), _statusText.length());
+        writeHead("\r\n", 2);
+      }
 
-    // Each header, like: "Host: myEsp32\r\n"
-    std::vector<HTTPHeader *> * headers = _headers.getAll();
-    for(std::vector<HTTPHeader*>::iterator header = headers->begin(); header != headers->end(); ++header) {
-      printInternal((*header)->print()+"\r\n", true);
+      // Each header, like: "Host: myEsp32\r\n"
+      for(size_t i = 0; i < _headers->size(); i++) {
+        HTTPHeaderRef header = _headers->at(i);
+        writeHead(header.name, header.nameLength);
+        writeHead(": ", 2);
+        writeHead(header.value, header.valueLength);
+        writeHead("\r\n", 2);
+      }
+      writeHead("\r\n", 2);
     }
-    printInternal("\r\n", true);
 
     _headerWritten=true;
   }
 }
 
+void HTTPResponse::writeHead(const char * data, size_t length) {
+  _con->writeBuffer((byte*)data, length);
+}
+
 /**
  * This method can be called to cancel the ongoing transmission and send the error page (if possible)
  */
@@ -132,13 +221,9 @@ void HTTPResponse::error() {
   _con->signalRequestError();
 }
 
-void HTTPResponse::printInternal(const std::string &str, bool skipBuffer) {
-  writeBytesInternal((uint8_t*)str.c_str(), str.length(), skipBuffer);
-}
-
-size_t HTTPResponse::writeBytesInternal(const void * data, int length, bool skipBuffer) {
+size_t HTTPResponse::writeBytesInternal(const void * data, int length) {
   if (!_isError) {
-    if (isResponseBuffered() && !skipBuffer) {
+    if (isResponseBuffered()) {
       // We are buffering ...
       if(length <= _responseCacheSize - _responseCachePointer) {
         // ... and there is space left in the buffer -> Write to buffer
@@ -151,15 +236,23 @@ size_t HTTPResponse::writeBytesInternal(const void * data, int length, bool skip
         return length;
       } else {
         // .., and the buffer is too small. This is the point where we switch from
-        // caching to streaming
+        // caching to streaming. If the handler did not set the length, we use chunked
+        // encoding, so that the client is still able to find the end of the response.
         if (!_headerWritten) {
-          setHeader("Connection", "close");
+          if (_headers->has(HEADER_CONTENT_LENGTH)) {
+            _isLengthKnown = true;
+          } else if (_con->supportsChunkedEncoding()) {
+            _headers->set(HEADER_TRANSFER_ENCODING, "chunked");
+            _isChunked = true;
+          } else {
+            _headers->set(HEADER_CONNECTION, "close");
+          }
         }
         drainBuffer(true);
       }
     }
 
-    return _con->writeBuffer((byte*)data, length);
+    return writeBody(data, length);
   } else {
     return 0;
   }
@@ -167,8 +260,9 @@ size_t HTTPResponse::writeBytesInternal(const void * data, int length, bool skip
 
 void HTTPResponse::drainBuffer(bool onOverflow) {
   if (!_headerWritten) {
-    if (_responseCache != NULL && !onOverflow) {
-      _headers.set(new HTTPHeader("Content-Length", intToString(_responseCachePointer)));
+    // 204 and 304 responses never have a body, so they do not announce its length
+    if (_responseCache != NULL && !onOverflow && _statusCode != 204 && _statusCode != 304) {
+      _headers->set(HEADER_CONTENT_LENGTH, intToString(_responseCachePointer));
     }
     printHeader();
   }
@@ -178,11 +272,30 @@ void HTTPResponse::drainBuffer(bool onOverflow) {
     // Check for 0 as it may be an overflow reaction without any data that has been written earlier
     if(_responseCachePointer > 0) {
       // FIXME: Return value?
-      _con->writeBuffer((byte*)_responseCache, _responseCachePointer);
+      writeBody(_responseCache, _responseCachePointer);
     }
-    delete[] _responseCache;
+    // The cache belongs to the connection, the response only stops using it
     _responseCache = NULL;
   }
 }
 
+/**
+ * Sends a part of the response body, framed as a chunk if chunked encoding is used.
+ */
+size_t HTTPResponse::writeBody(const void * data, size_t length) {
+  if (!_isChunked) {
+    return _con->writeBuffer((byte*)data, length);
+  }
+  // An empty chunk would mark the end of the response
+  if (length == 0) {
+    return 0;
+  }
+  char chunkHeader[12];
+  int chunkHeaderLength = snprintf(chunkHeader, sizeof(chunkHeader), "%x\r\n", (unsigned int)length);
+  _con->writeBuffer((byte*)chunkHeader, chunkHeaderLength);
+  size_t written = _con->writeBuffer((byte*)data, length);
+  _con->writeBuffer((byte*)"\r\n", 2);
+  return written;
+}
+
 } /* namespace httpsserver */
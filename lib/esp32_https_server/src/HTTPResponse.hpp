@@ -24,7 +24,7 @@ namespace httpsserver {
  */
 class HTTPResponse : public Print {
 public:
-  HTTPResponse(ConnectionContext * con);
+  HTTPResponse(ConnectionContext * con, HTTPHeaders * headers, byte * responseCache);
   virtual ~HTTPResponse();
 
   void setStatusCode(uint16_t statusCode);
@@ -33,33 +33,50 @@ public:
   std::string getStatusText();
   void setHeader(std::string const &name, std::string const &value);
   std::string getHeader(std::string const &name);
+  HTTPHeaders * getHTTPHeaders();
   bool isHeaderWritten();
 
   void printStd(std::string const &str);
+  void sendPrerendered(const char * head, size_t headLength, const uint8_t * body, size_t bodyLength);
 
   // From Print:
   size_t write(const uint8_t *buffer, size_t size);
   size_t write(uint8_t);
+  void flush();
 
   void error();
 
   bool isResponseBuffered();
+  bool isKeepAlivePossible();
   void finalize();
 
   ConnectionContext * _con;
   
 private:
   void printHeader();
-  void printInternal(const std::string &str, bool skipBuffer = false);
-  size_t writeBytesInternal(const void * data, int length, bool skipBuffer = false);
+  void writeHead(const char * data, size_t length);
+  size_t writeBytesInternal(const void * data, int length);
+  size_t writeBody(const void * data, size_t length);
   void drainBuffer(bool onOverflow = false);
 
   uint16_t _statusCode;
   std::string _statusText;
-  HTTPHeaders _headers;
+  // Owned by the connection and reused for every response
+  HTTPHeaders * _headers;
   bool _headerWritten;
   bool _isError;
 
+  // Set if the response is streamed with Transfer-Encoding: chunked
+  bool _isChunked;
+  // Set if the length of a streamed response has been set by the handler
+  bool _isLengthKnown;
+
+  // Response that has been rendered in advance, see sendPrerendered()
+  const char * _prerenderedHead;
+  size_t _prerenderedHeadLength;
+  const uint8_t * _prerenderedBody;
+  size_t _prerenderedBodyLength;
+
   // Response cache
   byte * _responseCache;
   size_t _responseCacheSize;
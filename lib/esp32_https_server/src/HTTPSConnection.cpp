@@ -1,11 +1,16 @@
 #include "HTTPSConnection.hpp"
 
+#include "SSLPlatform.hpp"
+
 namespace httpsserver {
 
 
 HTTPSConnection::HTTPSConnection(ResourceResolver * resResolver):
   HTTPConnection(resResolver) {
   _ssl = NULL;
+  _handshakeWantsWrite = false;
+  _handshakeStartTS = 0;
+  _sessionCache = NULL;
 }
 
 HTTPSConnection::~HTTPSConnection() {
@@ -13,6 +18,17 @@ HTTPSConnection::~HTTPSConnection() {
   closeConnection();
 }
 
+void HTTPSConnection::reset() {
+  // Should already be done by closeConnection(), but we do not want to leak the SSL context
+  if (_ssl) {
+    SSL_free(_ssl);
+    _ssl = NULL;
+  }
+  _handshakeWantsWrite = false;
+  _sessionCache = NULL;
+  HTTPConnection::reset();
+}
+
 bool HTTPSConnection::isSecure() {
   return true;
 }
@@ -21,8 +37,13 @@ bool HTTPSConnection::isSecure() {
  * Initializes the connection from a server socket.
  *
  * The call WILL BLOCK if accept(serverSocketID) blocks. So use select() to check for that in advance.
+ *
+ * The TLS handshake is not performed here. The connection enters STATE_HANDSHAKE instead, and loop()
+ * advances the handshake whenever the client has sent data. If the mbedtls objects of the SSL object
+ * cannot be accessed on this esp-idf version (see SSLPlatform.hpp), the handshake is done here with a
+ * blocking SSL_accept().
  */
-int HTTPSConnection::initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeaders *defaultHeaders) {
+int HTTPSConnection::initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeaders *defaultHeaders, SSLSessionCache * sessionCache) {
   if (_connectionState == STATE_UNDEFINED) {
     // Let the base class connect the plain tcp socket
     int resSocket = HTTPConnection::initialize(serverSocketID, defaultHeaders);
@@ -37,13 +58,38 @@ int HTTPSConnection::initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeader
         int success = SSL_set_fd(_ssl, resSocket);
         if (success) {
 
+          _handshakeStartTS = millis();
+
+          // Allow the client to resume a previous session
+          _sessionCache = sessionCache;
+          if (_sessionCache) {
+            _sessionCache->attach(_ssl);
+          }
+
+#if HTTPS_SSL_PLATFORM_ACCESS
+          // SSL_accept() repeats the handshake until it is done, even on a non-blocking socket. So
+          // handshake() drives the mbedtls context instead, which returns once the socket would
+          // block.
+          if (prepareSSLPlatformHandshake(_ssl)) {
+            fcntl(resSocket, F_SETFL, fcntl(resSocket, F_GETFL, 0) | O_NONBLOCK);
+            _handshakeWantsWrite = false;
+            _connectionState = STATE_HANDSHAKE;
+            return resSocket;
+          } else {
+            HTTPS_LOGE("Could not set the server certificate. Aborting handshake. FID=%d", resSocket);
+          }
+#else
           // Perform the handshake
-          success = SSL_accept(_ssl);
-          if (success) {
+          if (SSL_accept(_ssl) == 1) {
+            HTTPS_LOGI("Handshake done in %lu ms. FID=%d", millis() - _handshakeStartTS, resSocket);
+            if (_sessionCache) {
+              _sessionCache->handshakeDone();
+            }
             return resSocket;
           } else {
             HTTPS_LOGE("SSL_accept failed. Aborting handshake. FID=%d", resSocket);
           }
+#endif
         } else {
           HTTPS_LOGE("SSL_set_fd failed. Aborting handshake. FID=%d", resSocket);
         }
@@ -52,7 +98,7 @@ int HTTPSConnection::initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeader
       }
 
     } else {
-      HTTPS_LOGE("Could not accept() new connection. FID=%d", resSocket);
+      HTTPS_LOGD("No TCP connection for TLS handshake. FID=%d", resSocket);
     }
 
     _connectionState = STATE_ERROR;
@@ -66,12 +112,60 @@ int HTTPSConnection::initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeader
   return -1;
 }
 
+/**
+ * Performs the next steps of the TLS handshake. Returns as soon as it has to wait for the client,
+ * loop() will call it again once the socket is ready.
+ */
+void HTTPSConnection::handshake() {
+#if HTTPS_SSL_PLATFORM_ACCESS
+  int res = stepSSLPlatformHandshake(_ssl);
+  if (res == 0) {
+    // Handshake done. Reading is controlled by select() from now on, and writes expect a
+    // blocking socket.
+    int fd = getSocket();
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+    // The cipher suite shows the key type of the certificate (ECDSA or RSA)
+    HTTPS_LOGI("Handshake done in %lu ms, %s. FID=%d", millis() - _handshakeStartTS,
+      mbedtls_ssl_get_ciphersuite(getSSLPlatformContext(_ssl)), fd);
+    if (_sessionCache) {
+      _sessionCache->handshakeDone();
+    }
+    _connectionState = STATE_INITIAL;
+  } else if (res == MBEDTLS_ERR_SSL_WANT_READ) {
+    _handshakeWantsWrite = false;
+  } else if (res == MBEDTLS_ERR_SSL_WANT_WRITE) {
+    _handshakeWantsWrite = true;
+  } else {
+    HTTPS_LOGE("Handshake failed (-0x%04x). FID=%d", -res, getSocket());
+    _connectionState = STATE_ERROR;
+    closeConnection();
+  }
+#else
+  // The handshake has already been done by initialize()
+  _connectionState = STATE_INITIAL;
+#endif
+}
+
+bool HTTPSConnection::wantsWrite() {
+  return _connectionState == STATE_HANDSHAKE && _handshakeWantsWrite;
+}
 
 void HTTPSConnection::closeConnection() {
 
+  // Without a completed handshake, there is no TLS session that could be shut down
+  if (_connectionState == STATE_HANDSHAKE && _ssl) {
+    SSL_free(_ssl);
+    _ssl = NULL;
+  }
+
   // FIXME: Copy from HTTPConnection, could be done better probably
   if (_connectionState != STATE_ERROR && _connectionState != STATE_CLOSED) {
 
+    // Send what is left of the response before the TLS session is shut down
+    if (_connectionState != STATE_CLOSING) {
+      flushOutput();
+    }
+
     // First call to closeConnection - set the timestamp to calculate the timeout later on
     if (_connectionState != STATE_CLOSING) {
       _shutdownTS = millis();
@@ -89,6 +183,10 @@ void HTTPSConnection::closeConnection() {
       // This means we are safe to close the socket
       SSL_free(_ssl);
       _ssl = NULL;
+    } else if (_clientState == CSTATE_CLOSED) {
+      // The client has closed the connection without confirming the shutdown, nothing will follow
+      SSL_free(_ssl);
+      _ssl = NULL;
     } else if (_shutdownTS + HTTPS_SHUTDOWN_TIMEOUT < millis()) {
       // The timeout has been hit, we force SSL shutdown now by freeing the context
       SSL_free(_ssl);
@@ -104,7 +202,7 @@ void HTTPSConnection::closeConnection() {
   }
 }
 
-size_t HTTPSConnection::writeBuffer(byte* buffer, size_t length) {
+size_t HTTPSConnection::writeBytesFromBuffer(byte* buffer, size_t length) {
   return SSL_write(_ssl, buffer, length);
 }
 
@@ -113,11 +211,11 @@ size_t HTTPSConnection::readBytesToBuffer(byte* buffer, size_t length) {
 }
 
 size_t HTTPSConnection::pendingByteCount() {
-  return SSL_pending(_ssl);
+  return _ssl ? SSL_pending(_ssl) : 0;
 }
 
 bool HTTPSConnection::canReadData() {
-  return HTTPConnection::canReadData() || (SSL_pending(_ssl) > 0);
+  return HTTPConnection::canReadData() || (pendingByteCount() > 0);
 }
 
 } /* namespace httpsserver */
@@ -23,6 +23,7 @@
 #include "ResourceNode.hpp"
 #include "HTTPRequest.hpp"
 #include "HTTPResponse.hpp"
+#include "SSLSessionCache.hpp"
 
 namespace httpsserver {
 
@@ -34,9 +35,11 @@ public:
   HTTPSConnection(ResourceResolver * resResolver);
   virtual ~HTTPSConnection();
 
-  virtual int initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeaders *defaultHeaders);
+  virtual int initialize(int serverSocketID, SSL_CTX * sslCtx, HTTPHeaders *defaultHeaders, SSLSessionCache * sessionCache = NULL);
   virtual void closeConnection();
+  virtual void reset();
   virtual bool isSecure();
+  virtual bool wantsWrite();
 
 protected:
   friend class HTTPRequest;
@@ -45,12 +48,21 @@ protected:
   virtual size_t readBytesToBuffer(byte* buffer, size_t length);
   virtual size_t pendingByteCount();
   virtual bool canReadData();
-  virtual size_t writeBuffer(byte* buffer, size_t length);
+  virtual size_t writeBytesFromBuffer(byte* buffer, size_t length);
+  virtual void handshake();
 
 private:
   // SSL context for this connection
   SSL * _ssl;
 
+  // Whether the handshake waits for the socket to become writable (or readable, if false)
+  bool _handshakeWantsWrite;
+  // Start of the handshake, to log its duration
+  unsigned long _handshakeStartTS;
+
+  // Sessions that may be resumed by the client, may be NULL
+  SSLSessionCache * _sessionCache;
+
 };
 
 } /* namespace httpsserver */
@@ -1,14 +1,24 @@
 #include "HTTPSServer.hpp"
 
+#include "SSLPlatform.hpp"
+
+// The OpenSSL layer of the esp-idf lets mbedtls detect the key type, so it does not define all of them
+#ifndef EVP_PKEY_EC
+#define EVP_PKEY_EC 408
+#endif
+
 namespace httpsserver {
 
 
-HTTPSServer::HTTPSServer(SSLCert * cert, const uint16_t port, const uint8_t maxConnections, const in_addr_t bindAddress):
+HTTPSServer::HTTPSServer(SSLCert * cert, const uint16_t port, const uint8_t maxConnections, const in_addr_t bindAddress,
+  const uint16_t sessionCacheSize, const uint32_t sessionTicketLifetime):
   HTTPServer(port, maxConnections, bindAddress),
-  _cert(cert) {
+  _cert(cert),
+  _sessionCache(sessionCacheSize, sessionTicketLifetime) {
 
   // Configure runtime data
   _sslctx = NULL;
+  _rejectSSL = NULL;
 }
 
 HTTPSServer::~HTTPSServer() {
@@ -47,17 +57,130 @@ uint8_t HTTPSServer::setupSocket() {
 
 void HTTPSServer::teardownSocket() {
 
+  // The rejected client has to be released before the context
+  if (_rejectSSL) {
+    SSL_free(_rejectSSL);
+    _rejectSSL = NULL;
+  }
+
   HTTPServer::teardownSocket();
 
   // Tear down the SSL context
   SSL_CTX_free(_sslctx);
   _sslctx = NULL;
+
+  // Sessions cannot be resumed with a new context anyway
+  _sessionCache.teardown();
+}
+
+/**
+ * Returns the number of TLS handshakes that resumed a previous session
+ */
+uint32_t HTTPSServer::getResumedHandshakeCount() {
+  return _sessionCache.getResumedHandshakeCount();
+}
+
+/**
+ * Returns the number of TLS handshakes that required a full key exchange
+ */
+uint32_t HTTPSServer::getFullHandshakeCount() {
+  return _sessionCache.getFullHandshakeCount();
+}
+
+HTTPConnection * HTTPSServer::newConnection() {
+  return new HTTPSConnection(this);
 }
 
 int HTTPSServer::createConnection(int idx) {
-  HTTPSConnection * newConnection = new HTTPSConnection(this);
-  _connections[idx] = newConnection;
-  return newConnection->initialize(_socket, _sslctx, &_defaultHeaders);
+  return static_cast<HTTPSConnection*>(_connections[idx])->initialize(_socket, _sslctx, &_defaultHeaders, &_sessionCache);
+}
+
+/**
+ * Rejects a client during overload. The 503 response can only be sent after a TLS handshake, so the
+ * client is moved into the reserved slot, where advanceRejection() performs the handshake without
+ * blocking the server. Only one client can be in the slot, further clients are disconnected right
+ * away, as with OVERLOAD_CLOSE.
+ *
+ * If the mbedtls objects cannot be accessed on this esp-idf version (see SSLPlatform.hpp), the
+ * handshake blocks the server for up to HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT.
+ */
+void HTTPSServer::rejectConnection(int clientSocket) {
+  if (_overloadMode == OVERLOAD_RESPOND && _rejectSocket < 0) {
+#if HTTPS_SSL_PLATFORM_ACCESS
+    SSL * ssl = SSL_new(_sslctx);
+    if (ssl != NULL) {
+      if (SSL_set_fd(ssl, clientSocket) == 1 && prepareSSLPlatformHandshake(ssl)) {
+        fcntl(clientSocket, F_SETFL, fcntl(clientSocket, F_GETFL, 0) | O_NONBLOCK);
+        _rejectSSL = ssl;
+        _rejectSocket = clientSocket;
+        _rejectWantsWrite = false;
+        _rejectTS = millis();
+        return;
+      }
+      SSL_free(ssl);
+    }
+#else
+    // The socket may inherit the non-blocking mode of the server socket
+    fcntl(clientSocket, F_SETFL, fcntl(clientSocket, F_GETFL, 0) & ~O_NONBLOCK);
+    timeval timeout;
+    timeout.tv_sec = HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT / 1000;
+    timeout.tv_usec = (HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT % 1000) * 1000;
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(clientSocket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    SSL * ssl = SSL_new(_sslctx);
+    if (ssl != NULL) {
+      if (SSL_set_fd(ssl, clientSocket) == 1 && SSL_accept(ssl) == 1) {
+        SSL_write(ssl, _overloadResponse.data(), _overloadResponse.length());
+        SSL_shutdown(ssl);
+      } else {
+        HTTPS_LOGD("TLS handshake with rejected client failed");
+      }
+      SSL_free(ssl);
+    }
+#endif
+  }
+  close(clientSocket);
+}
+
+/**
+ * Advances the handshake with the client in the reserved slot. Once it is done, the 503 response is
+ * sent together with the close notification, and the base class waits for the client to close the
+ * connection.
+ */
+void HTTPSServer::advanceRejection(bool timeout) {
+  if (_rejectSSL == NULL) {
+    HTTPServer::advanceRejection(timeout);
+    return;
+  }
+
+#if HTTPS_SSL_PLATFORM_ACCESS
+  if (!timeout) {
+    int res = stepSSLPlatformHandshake(_rejectSSL);
+    if (res == MBEDTLS_ERR_SSL_WANT_READ || res == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      _rejectWantsWrite = (res == MBEDTLS_ERR_SSL_WANT_WRITE);
+      return;
+    }
+    if (res == 0) {
+      // The response fits into the send buffer of a new socket, so this does not have to wait
+      SSL_write(_rejectSSL, _overloadResponse.data(), _overloadResponse.length());
+      SSL_shutdown(_rejectSSL);
+      SSL_free(_rejectSSL);
+      _rejectSSL = NULL;
+      _rejectWantsWrite = false;
+      // Nothing more is sent, but the client still has to receive the response
+      shutdown(_rejectSocket, SHUT_WR);
+      return;
+    }
+    HTTPS_LOGD("TLS handshake with rejected client failed (-0x%04x)", -res);
+  } else {
+    HTTPS_LOGD("TLS handshake with rejected client timed out");
+  }
+#endif
+
+  SSL_free(_rejectSSL);
+  _rejectSSL = NULL;
+  HTTPServer::advanceRejection(true);
 }
 
 /**
@@ -67,7 +190,12 @@ uint8_t HTTPSServer::setupSSLCTX() {
   _sslctx = SSL_CTX_new(TLSv1_2_server_method());
   if (_sslctx) {
     // Set SSL Timeout to 5 minutes
-    SSL_CTX_set_timeout(_sslctx, 300);
+    SSL_CTX_set_timeout(_sslctx, HTTPS_SESSION_TIMEOUT);
+
+    // Resumption is optional, the server works without it
+    if (!_sessionCache.setup()) {
+      HTTPS_LOGW("TLS session resumption is not available");
+    }
     return 1;
   } else {
     _sslctx = NULL;
@@ -89,11 +217,20 @@ uint8_t HTTPSServer::setupCert() {
 
   // Then set the private key accordingly
   if (ret) {
-    ret = SSL_CTX_use_RSAPrivateKey_ASN1(
-      _sslctx,
-      _cert->getPKData(),
-      _cert->getPKLength()
-    );
+    if (_cert->getPKType() == KEYTYPE_EC) {
+      ret = SSL_CTX_use_PrivateKey_ASN1(
+        EVP_PKEY_EC,
+        _sslctx,
+        _cert->getPKData(),
+        _cert->getPKLength()
+      );
+    } else {
+      ret = SSL_CTX_use_RSAPrivateKey_ASN1(
+        _sslctx,
+        _cert->getPKData(),
+        _cert->getPKLength()
+      );
+    }
   }
 
   return ret;
@@ -21,6 +21,7 @@
 #include "ResolvedResource.hpp"
 #include "HTTPSConnection.hpp"
 #include "SSLCert.hpp"
+#include "SSLSessionCache.hpp"
 
 namespace httpsserver {
 
@@ -29,16 +30,25 @@ namespace httpsserver {
  */
 class HTTPSServer : public HTTPServer {
 public:
-  HTTPSServer(SSLCert * cert, const uint16_t portHTTPS = 443, const uint8_t maxConnections = 4, const in_addr_t bindAddress = 0);
+  HTTPSServer(SSLCert * cert, const uint16_t portHTTPS = 443, const uint8_t maxConnections = 4, const in_addr_t bindAddress = 0,
+    const uint16_t sessionCacheSize = HTTPS_SESSION_CACHE_SIZE, const uint32_t sessionTicketLifetime = HTTPS_SESSION_TICKET_LIFETIME);
   virtual ~HTTPSServer();
 
+  // Statistics about TLS session resumption
+  uint32_t getResumedHandshakeCount();
+  uint32_t getFullHandshakeCount();
+
 private:
   // Static configuration. Port, keys, etc. ====================
   // Certificate that should be used (includes private key)
   SSLCert * _cert;
+  // Storage for TLS sessions that can be resumed
+  SSLSessionCache _sessionCache;
  
   //// Runtime data ============================================
   SSL_CTX * _sslctx;
+  // TLS session of the client in the reserved slot for rejected clients, see rejectConnection()
+  SSL * _rejectSSL;
   // Status of the server: Are we running, or not?
 
   // Setup functions
@@ -48,7 +58,10 @@ private:
   uint8_t setupCert();
 
   // Helper functions
+  virtual HTTPConnection * newConnection();
   virtual int createConnection(int idx);
+  virtual void rejectConnection(int clientSocket);
+  virtual void advanceRejection(bool timeout);
 };
 
 } /* namespace httpsserver */
@@ -46,7 +46,7 @@
 
 // Maximum of header lines that are parsed
 #ifndef HTTPS_REQUEST_MAX_HEADERS
-#define HTTPS_REQUEST_MAX_HEADERS               20
+#define HTTPS_REQUEST_MAX_HEADERS               32
 #endif
 
 // Maximum length of the request line (GET /... HTTP/1.1)
@@ -59,11 +59,39 @@
 #define HTTPS_REQUEST_MAX_HEADER_LENGTH        384
 #endif
 
+// Maximum size of the whole request head (request line and all header lines, including line breaks).
+// Larger heads are rejected with 431. The buffer is part of every connection in the pool, so it is
+// sized for typical browser requests rather than for the limits above. Must not exceed 65535.
+#ifndef HTTPS_REQUEST_MAX_HEAD_SIZE
+#define HTTPS_REQUEST_MAX_HEAD_SIZE           4096
+#endif
+
+// Growth step (in bytes) of the storage for header names and values in HTTPHeaders
+#ifndef HTTPS_HEADERS_ARENA_SIZE
+#define HTTPS_HEADERS_ARENA_SIZE               512
+#endif
+
+// Growth step (number of headers) of the header table in HTTPHeaders
+#ifndef HTTPS_HEADERS_TABLE_SIZE
+#define HTTPS_HEADERS_TABLE_SIZE               16
+#endif
+
+// Number of seeds that the compiler tries to find a perfect hash for a StaticRouteTable
+#ifndef HTTPS_STATIC_ROUTE_MAX_SEEDS
+#define HTTPS_STATIC_ROUTE_MAX_SEEDS           256
+#endif
+
 // Chunk size used for reading data from the ssl-enabled socket
 #ifndef HTTPS_CONNECTION_DATA_CHUNK_SIZE
 #define HTTPS_CONNECTION_DATA_CHUNK_SIZE       512
 #endif
 
+// Size of the per-connection output buffer that collects small writes. With the overhead of a TLS
+// record, 1400 bytes of payload still fit into a single TCP segment
+#ifndef HTTPS_CONNECTION_OUTPUT_BUFFER_SIZE
+#define HTTPS_CONNECTION_OUTPUT_BUFFER_SIZE    1400
+#endif
+
 // Size (in bytes) of the Connection:keep-alive Cache (we need to be able to
 // store-and-forward the response to calculate the content-size)
 #ifndef HTTPS_KEEPALIVE_CACHESIZE
@@ -75,12 +103,39 @@
 #define HTTPS_CONNECTION_TIMEOUT               20000
 #endif
 
+// Value of the Retry-After header (s) that is sent to clients that are rejected in overload mode
+#ifndef HTTPS_OVERLOAD_RETRY_AFTER
+#define HTTPS_OVERLOAD_RETRY_AFTER             5
+#endif
+
+// Time that a client which is rejected in overload mode may occupy the reserved slot for the TLS
+// handshake, the 503 response and the wait for the client to close the connection (ms)
+#ifndef HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT
+#define HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT       1000
+#endif
+
 // Timeout used to wait for shutdown of SSL connection (ms)
 // (time for the client to return notify close flag) - without it, truncation attacks might be possible
 #ifndef HTTPS_SHUTDOWN_TIMEOUT
 #define HTTPS_SHUTDOWN_TIMEOUT                 5000
 #endif
 
+// Lifetime of a TLS session (s). Resuming a session is only possible within this time
+#ifndef HTTPS_SESSION_TIMEOUT
+#define HTTPS_SESSION_TIMEOUT                  300
+#endif
+
+// Default number of TLS sessions kept in the server-side session cache (0 disables the cache)
+#ifndef HTTPS_SESSION_CACHE_SIZE
+#define HTTPS_SESSION_CACHE_SIZE               4
+#endif
+
+// Default lifetime of a session ticket key (s). The key is rotated after this time, tickets issued
+// with the previous key remain valid for another period. 0 disables session tickets
+#ifndef HTTPS_SESSION_TICKET_LIFETIME
+#define HTTPS_SESSION_TICKET_LIFETIME          3600
+#endif
+
 // Length of a SHA1 hash
 #ifndef HTTPS_SHA1_LENGTH
 #define HTTPS_SHA1_LENGTH                      20
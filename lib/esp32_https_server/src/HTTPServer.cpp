@@ -14,7 +14,15 @@ HTTPServer::HTTPServer(const uint16_t port, const uint8_t maxConnections, const
 
   // Configure runtime data
   _socket = -1;
+  _wakeupSocket = -1;
   _running = false;
+  _evictedConnectionCount = 0;
+  _evictionPending = false;
+  _rejectedConnectionCount = 0;
+  _overloadMode = OVERLOAD_WAIT;
+  _rejectSocket = -1;
+  _rejectWantsWrite = false;
+  _rejectTS = 0;
 }
 
 HTTPServer::~HTTPServer() {
@@ -35,6 +43,10 @@ HTTPServer::~HTTPServer() {
 uint8_t HTTPServer::start() {
   if (!_running) {
     if (setupSocket()) {
+      // Create the connection pool once, so that accepting a client does not need to allocate memory
+      for(uint8_t i = 0; i < _maxConnections; i++) {
+        _connections[i] = newConnection();
+      }
       _running = true;
       return 1;
     }
@@ -62,14 +74,13 @@ void HTTPServer::stop() {
     while(hasOpenConnections) {
       hasOpenConnections = false;
       for(int i = 0; i < _maxConnections; i++) {
-        if (_connections[i] != NULL) {
+        if (!_connections[i]->isFree()) {
           _connections[i]->closeConnection();
 
           // Check if closing succeeded. If not, we need to call the close function multiple times
           // and wait for the client
           if (_connections[i]->isClosed()) {
-            delete _connections[i];
-            _connections[i] = NULL;
+            _connections[i]->reset();
           } else {
             hasOpenConnections = true;
           }
@@ -78,6 +89,12 @@ void HTTPServer::stop() {
       delay(1);
     }
 
+    // Free the connection pool
+    for(int i = 0; i < _maxConnections; i++) {
+      delete _connections[i];
+      _connections[i] = NULL;
+    }
+
     teardownSocket();
 
   }
@@ -89,79 +106,328 @@ void HTTPServer::stop() {
  * This could be used for example to add a Server: header or for CORS options
  */
 void HTTPServer::setDefaultHeader(std::string name, std::string value) {
-  _defaultHeaders.set(new HTTPHeader(name, value));
+  _defaultHeaders.set(name, value);
+}
+
+/**
+ * Defines what happens to new clients while all connections are in use and none of them can be
+ * closed to make space. By default, they wait in the listen backlog, which may take up to
+ * HTTPS_CONNECTION_TIMEOUT. With OVERLOAD_RESPOND or OVERLOAD_CLOSE, they are rejected right away.
+ *
+ * @param mode The HTTPOverloadMode to use
+ * @param retryAfter Value of the Retry-After header for OVERLOAD_RESPOND, in seconds
+ */
+void HTTPServer::setOverloadMode(HTTPOverloadMode mode, uint32_t retryAfter) {
+  _overloadMode = mode;
+
+  // The response is the same for every client, so it is only rendered once
+  std::string body = "503 Service Unavailable";
+  _overloadResponse = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: ";
+  _overloadResponse += intToString(retryAfter);
+  _overloadResponse += "\r\nConnection: close\r\nContent-Type: text/plain;charset=utf8\r\nContent-Length: ";
+  _overloadResponse += intToString(body.length());
+  _overloadResponse += "\r\n\r\n";
+  _overloadResponse += body;
 }
 
 /**
  * The loop method can either be called by periodical interrupt or in the main loop and handles processing
  * of data
+ *
+ * A single select() call is used to check the server socket and all connections for readiness. Only
+ * connections that are ready (or have pending work, like a request that is currently processed or a
+ * timeout) are processed.
  */
 void HTTPServer::loop() {
+  loop(0);
+}
+
+/**
+ * Like loop(), but if there is nothing to do, the call blocks until a socket becomes ready, a connection
+ * times out, wakeup() is called or timeoutMs milliseconds have passed.
+ *
+ * Use this instead of calling loop() and delay() to save CPU time while the server is idle without adding
+ * latency to incoming requests.
+ */
+void HTTPServer::loop(uint32_t timeoutMs) {
 
   // Only handle requests if the server is still running
-  if(!_running) return;
+  if(!_running) {
+    delay(timeoutMs);
+    return;
+  }
 
-  // Step 1: Process existing connections
-  // Process open connections and store the index of a free connection
-  // (we might use that later on)
-  int freeConnectionIdx = -1;
+  // Step 1: Clean up closed connections and build the socket sets for select()
+  fd_set readSockets;
+  fd_set writeSockets;
+  FD_ZERO(&readSockets);
+  FD_ZERO(&writeSockets);
+  int maxSocket = -1;
+  int freeConnectionCount = 0;
+  int idleConnectionCount = 0;
+  // Time that we may block in select()
+  unsigned long waitMs = timeoutMs;
   for (int i = 0; i < _maxConnections; i++) {
-    // Fetch a free index in the pointer array
-    if (_connections[i] == NULL) {
-      freeConnectionIdx = i;
+    // check if the connection is open or closed:
+    if (_connections[i]->isClosed()) {
+      // if it's closed, return it to the pool:
+      _connections[i]->reset();
+    }
 
+    if (_connections[i]->isFree()) {
+      freeConnectionCount++;
     } else {
-      // if there is a connection (_connections[i]!=NULL), check if its open or closed:
-      if (_connections[i]->isClosed()) {
-        // if it's closed, clean up:
-        delete _connections[i];
-        _connections[i] = NULL;
-        freeConnectionIdx = i;
+      if (_connections[i]->isIdleKeepAlive()) {
+        idleConnectionCount++;
+      }
+      int connectionSocket = _connections[i]->getSocket();
+      if (connectionSocket >= 0) {
+        FD_SET(connectionSocket, &readSockets);
+        if (_connections[i]->wantsWrite()) {
+          FD_SET(connectionSocket, &writeSockets);
+        }
+        maxSocket = std::max(maxSocket, connectionSocket);
+      }
+
+      // Do not wait if there is something to do anyway, or longer than until the next timeout
+      if (_connections[i]->hasPendingWork()) {
+        waitMs = 0;
       } else {
-        // if not, process it:
-        _connections[i]->loop();
+        waitMs = std::min(waitMs, _connections[i]->getMillisUntilTimeout());
       }
     }
   }
- 
-  // Step 2: Check for new connections
-  // This makes only sense if there is space to store the connection
-  if (freeConnectionIdx > -1) {
 
-    // We create a file descriptor set to be able to use the select function
-    fd_set sockfds;
-    // Out socket is the only socket in this set
-    FD_ZERO(&sockfds);
-    FD_SET(_socket, &sockfds);
+  if (_wakeupSocket >= 0) {
+    FD_SET(_wakeupSocket, &readSockets);
+    maxSocket = std::max(maxSocket, _wakeupSocket);
+  }
+
+  // A client that is rejected in the reserved slot is released at its deadline at the latest
+  if (_rejectSocket >= 0) {
+    FD_SET(_rejectSocket, &readSockets);
+    if (_rejectWantsWrite) {
+      FD_SET(_rejectSocket, &writeSockets);
+    }
+    maxSocket = std::max(maxSocket, _rejectSocket);
+    unsigned long rejectMillis = millis() - _rejectTS;
+    waitMs = std::min(waitMs, rejectMillis < HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT ?
+      (unsigned long)HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT - rejectMillis : 0UL);
+  }
+
+  // New connections can only be accepted if there is space to store them, or if an idle
+  // keep-alive connection can be closed to make space. In overload mode, they are always accepted.
+  // While an evicted connection is shutting down, the waiting client stays in the backlog until its
+  // slot is free. Otherwise the server socket would stay readable and select() would not block.
+  if (freeConnectionCount > 0) {
+    _evictionPending = false;
+  }
+  bool acceptClients = !_evictionPending &&
+    (freeConnectionCount > 0 || idleConnectionCount > 0 || _overloadMode != OVERLOAD_WAIT);
+  if (acceptClients) {
+    FD_SET(_socket, &readSockets);
+    maxSocket = std::max(maxSocket, _socket);
+  }
 
-    // We define a "immediate" timeout
+  // Step 2: Check all sockets at once
+  if (maxSocket >= 0) {
     timeval timeout;
-    timeout.tv_sec  = 0;
-    timeout.tv_usec = 0; // Return immediately, if possible
+    timeout.tv_sec  = waitMs / 1000;
+    timeout.tv_usec = (waitMs % 1000) * 1000; // Return immediately, if waitMs is 0
 
-    // Wait for input
     // As by 2017-12-14, it seems that FD_SETSIZE is defined as 0x40, but socket IDs now
-    // start at 0x1000, so we need to use _socket+1 here
-    select(_socket + 1, &sockfds, NULL, NULL, &timeout);
+    // start at 0x1000, so we need to use maxSocket+1 here
+    if (select(maxSocket + 1, &readSockets, &writeSockets, NULL, &timeout) < 0) {
+      HTTPS_LOGE("select() failed");
+      FD_ZERO(&readSockets);
+      FD_ZERO(&writeSockets);
+    }
+  }
+
+  // Drain the wakeup socket, the wakeup has done its job by interrupting select()
+  if (_wakeupSocket >= 0 && FD_ISSET(_wakeupSocket, &readSockets)) {
+    byte wakeupData[8];
+    while (recv(_wakeupSocket, wakeupData, sizeof(wakeupData), MSG_DONTWAIT) > 0);
+  }
+
+  // Step 3: Process existing connections that are ready or have pending work
+  for (int i = 0; i < _maxConnections; i++) {
+    if (!_connections[i]->isFree()) {
+      int connectionSocket = _connections[i]->getSocket();
+      bool readReady = connectionSocket >= 0 && FD_ISSET(connectionSocket, &readSockets);
+      bool writeReady = connectionSocket >= 0 && FD_ISSET(connectionSocket, &writeSockets);
+      if (readReady || writeReady || _connections[i]->hasPendingWork()) {
+        _connections[i]->setReadReady(readReady);
+        _connections[i]->loop();
+      }
+    }
+  }
+
+  if (_rejectSocket >= 0) {
+    bool timeout = millis() - _rejectTS >= HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT;
+    if (timeout || FD_ISSET(_rejectSocket, &readSockets) || FD_ISSET(_rejectSocket, &writeSockets)) {
+      advanceRejection(timeout);
+    }
+  }
+
+  // Step 4: Accept new connections, as long as clients are waiting and we have space for them.
+  // The server socket is non-blocking, so accept() will fail when there are no more clients.
+  if (acceptClients && FD_ISSET(_socket, &readSockets)) {
+    // If the table is full, a client that is waiting for a slot is more important than one that
+    // only keeps its connection open
+    bool hasFreeConnection = false;
+    for (int i = 0; i < _maxConnections && !hasFreeConnection; i++) {
+      hasFreeConnection = _connections[i]->isFree();
+    }
+    if (!hasFreeConnection) {
+      hasFreeConnection = evictIdleConnection();
+      if (!hasFreeConnection && !_evictionPending && _overloadMode != OVERLOAD_WAIT) {
+        rejectConnections();
+      }
+    }
+
+    for (int i = 0; i < _maxConnections; i++) {
+      if (_connections[i]->isFree()) {
+        int socketIdentifier = createConnection(i);
+
+        // If initializing did not work, discard the new socket immediately and stop accepting
+        if (socketIdentifier < 0) {
+          _connections[i]->reset();
+          break;
+        }
+      }
+    }
+  }
+}
 
-    // There is input
-    if (FD_ISSET(_socket, &sockfds)) {
-      int socketIdentifier = createConnection(freeConnectionIdx);
+/**
+ * Interrupts a call to loop(timeoutMs) that is currently blocking, so that the server task can
+ * continue with its work. May be called from another task, but not from an ISR.
+ */
+void HTTPServer::wakeup() {
+  if (_wakeupSocket >= 0) {
+    sockaddr_in wakeupAddr;
+    socklen_t wakeupAddrLen = sizeof(wakeupAddr);
+    if (getsockname(_wakeupSocket, (struct sockaddr*)&wakeupAddr, &wakeupAddrLen) == 0) {
+      byte wakeupData = 0;
+      sendto(_wakeupSocket, &wakeupData, 1, 0, (struct sockaddr*)&wakeupAddr, wakeupAddrLen);
+    }
+  }
+}
 
-      // If initializing did not work, discard the new socket immediately
-      if (socketIdentifier < 0) {
-        delete _connections[freeConnectionIdx];
-        _connections[freeConnectionIdx] = NULL;
+/**
+ * Returns the number of idle keep-alive connections that have been closed because a new client
+ * was waiting while all connections were in use
+ */
+uint32_t HTTPServer::getEvictedConnectionCount() {
+  return _evictedConnectionCount;
+}
+
+/**
+ * Closes the idle keep-alive connection that has been inactive for the longest time. Returns true
+ * if a connection has been returned to the pool.
+ */
+bool HTTPServer::evictIdleConnection() {
+  int evictIdx = -1;
+  unsigned long evictIdleMillis = 0;
+  for (int i = 0; i < _maxConnections; i++) {
+    if (!_connections[i]->isFree() && _connections[i]->isIdleKeepAlive()) {
+      unsigned long idleMillis = _connections[i]->getIdleMillis();
+      if (evictIdx < 0 || idleMillis > evictIdleMillis) {
+        evictIdx = i;
+        evictIdleMillis = idleMillis;
       }
     }
+  }
+  if (evictIdx < 0) {
+    return false;
+  }
+
+  HTTPS_LOGI("Closing idle connection to accept a new client, idle for %lu ms. FID=%d",
+    evictIdleMillis, _connections[evictIdx]->getSocket());
+  _evictedConnectionCount++;
+  _connections[evictIdx]->closeConnection();
+  if (_connections[evictIdx]->isClosed()) {
+    _connections[evictIdx]->reset();
+    return true;
+  }
+  // The TLS shutdown is still in progress, the slot becomes free in one of the next loops
+  _evictionPending = true;
+  return false;
+}
+
+/**
+ * Returns the number of clients that have been rejected because all connections were in use
+ */
+uint32_t HTTPServer::getRejectedConnectionCount() {
+  return _rejectedConnectionCount;
+}
+
+/**
+ * Accepts the clients that are waiting and rejects them as configured by setOverloadMode(). At most
+ * _maxConnections clients are handled per call, so that the existing connections are not starved.
+ */
+void HTTPServer::rejectConnections() {
+  for (int i = 0; i < _maxConnections; i++) {
+    int clientSocket = accept(_socket, NULL, NULL);
+    if (clientSocket < 0) {
+      break;
+    }
+    HTTPS_LOGI("All connections in use, rejecting client. FID=%d", clientSocket);
+    _rejectedConnectionCount++;
+    rejectConnection(clientSocket);
+  }
+}
 
+/**
+ * Sends the pre-rendered 503 response (for OVERLOAD_RESPOND) and moves the client into the reserved
+ * slot (_rejectSocket). The request usually arrives after the response has been sent, and closing
+ * the socket then would reset the connection, so that most clients discard the response. loop()
+ * calls advanceRejection() whenever the socket is ready, until the client has closed the connection
+ * or HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT has passed. Only one client can be in the slot, further
+ * clients are disconnected right away, as with OVERLOAD_CLOSE.
+ */
+void HTTPServer::rejectConnection(int clientSocket) {
+  if (_overloadMode == OVERLOAD_RESPOND && _rejectSocket < 0) {
+    fcntl(clientSocket, F_SETFL, fcntl(clientSocket, F_GETFL, 0) | O_NONBLOCK);
+    // The response fits into the send buffer of a new socket, so this does not have to wait
+    if (send(clientSocket, _overloadResponse.data(), _overloadResponse.length(), 0) > 0) {
+      // Nothing more is sent, but the client still has to receive the response
+      shutdown(clientSocket, SHUT_WR);
+      _rejectSocket = clientSocket;
+      _rejectWantsWrite = false;
+      _rejectTS = millis();
+      return;
+    }
   }
+  close(clientSocket);
+}
+
+/**
+ * Advances the rejection of the client in the reserved slot. This implementation waits for the
+ * client to close the connection after the response has been sent, as closing a socket with unread
+ * data would reset the connection and discard the response. At the deadline, the socket is closed
+ * anyway.
+ *
+ * @param timeout Whether HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT has passed
+ */
+void HTTPServer::advanceRejection(bool timeout) {
+  byte discard[64];
+  int res;
+  while ((res = recv(_rejectSocket, discard, sizeof(discard), MSG_DONTWAIT)) > 0);
+  if (timeout || res == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+    close(_rejectSocket);
+    _rejectSocket = -1;
+    _rejectWantsWrite = false;
+  }
+}
+
+HTTPConnection * HTTPServer::newConnection() {
+  return new HTTPConnection(this);
 }
 
 int HTTPServer::createConnection(int idx) {
-  HTTPConnection * newConnection = new HTTPConnection(this);
-  _connections[idx] = newConnection;
-  return newConnection->initialize(_socket, &_defaultHeaders);
+  return _connections[idx]->initialize(_socket, &_defaultHeaders);
 }
 
 /**
@@ -181,9 +447,15 @@ uint8_t HTTPServer::setupSocket() {
     // Now bind the TCP socket we did create above to the socket address we specified
     // (The TCP-socket now listens on 0.0.0.0:port)
     int err = bind(_socket, (struct sockaddr* )&_sock_addr, sizeof(_sock_addr));
+    if(!err) {
+      // The server socket is non-blocking, so that loop() can accept all pending clients
+      // without blocking when there are none left
+      err = fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK) < 0;
+    }
     if(!err) {
       err = listen(_socket, _maxConnections);
       if (!err) {
+        setupWakeupSocket();
         return 1;
       } else {
         close(_socket);
@@ -202,10 +474,41 @@ uint8_t HTTPServer::setupSocket() {
  
 }
 
+/**
+ * Creates the UDP socket that is used by wakeup(). It is bound to an ephemeral port on the
+ * loopback interface. If that fails, the server works as well, but wakeup() has no effect.
+ */
+void HTTPServer::setupWakeupSocket() {
+  _wakeupSocket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (_wakeupSocket >= 0) {
+    sockaddr_in wakeupAddr;
+    memset(&wakeupAddr, 0, sizeof(wakeupAddr));
+    wakeupAddr.sin_family = AF_INET;
+    wakeupAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    wakeupAddr.sin_port = 0;
+    if (bind(_wakeupSocket, (struct sockaddr*)&wakeupAddr, sizeof(wakeupAddr)) != 0) {
+      HTTPS_LOGW("Could not create wakeup socket, wakeup() is not available");
+      close(_wakeupSocket);
+      _wakeupSocket = -1;
+    }
+  }
+}
+
 void HTTPServer::teardownSocket() {
   // Close the actual server sockets
   close(_socket);
   _socket = -1;
+
+  if (_wakeupSocket >= 0) {
+    close(_wakeupSocket);
+    _wakeupSocket = -1;
+  }
+
+  if (_rejectSocket >= 0) {
+    close(_rejectSocket);
+    _rejectSocket = -1;
+    _rejectWantsWrite = false;
+  }
 }
 
 } /* namespace httpsserver */
@@ -24,6 +24,24 @@
 
 namespace httpsserver {
 
+/**
+ * \brief Defines how the server treats new clients while all connections are in use
+ */
+enum HTTPOverloadMode {
+  /** Clients wait in the listen backlog until a connection becomes free (default) */
+  OVERLOAD_WAIT,
+  /**
+   * Clients are accepted, receive a 503 response with a Retry-After header and are disconnected.
+   * For HTTPS, this requires a TLS handshake. It is done without blocking the server for one client
+   * at a time, others are disconnected like with OVERLOAD_CLOSE. On esp-idf versions without access
+   * to the mbedtls objects (see SSLPlatform.hpp), the handshake blocks the server for up to
+   * HTTPS_OVERLOAD_HANDSHAKE_TIMEOUT per client
+   */
+  OVERLOAD_RESPOND,
+  /** Clients are accepted and disconnected right away, without any response */
+  OVERLOAD_CLOSE
+};
+
 /**
  * \brief Main implementation for the plain HTTP server. Use HTTPSServer for TLS support
  */
@@ -37,9 +55,18 @@ public:
   bool isRunning();
 
   void loop();
+  void loop(uint32_t timeoutMs);
+  void wakeup();
 
   void setDefaultHeader(std::string name, std::string value);
 
+  void setOverloadMode(HTTPOverloadMode mode, uint32_t retryAfter = HTTPS_OVERLOAD_RETRY_AFTER);
+
+  // Number of idle keep-alive connections that have been closed to accept new clients
+  uint32_t getEvictedConnectionCount();
+  // Number of clients that have been rejected, see setOverloadMode()
+  uint32_t getRejectedConnectionCount();
+
 protected:
   // Static configuration. Port, keys, etc. ====================
   // Certificate that should be used (includes private key)
@@ -51,24 +78,45 @@ protected:
   const in_addr_t _bindAddress;
 
   //// Runtime data ============================================
-  // The array of connections that are currently active
+  // The pool of connections. Created in start(), each object is reused for many clients
   HTTPConnection ** _connections;
   // Status of the server: Are we running, or not?
   boolean _running;
   // The server socket
   int _socket;
+  // UDP socket on the loopback interface, used by wakeup() to interrupt a blocking loop()
+  int _wakeupSocket;
 
   // The server socket address, that our service is bound to
   sockaddr_in _sock_addr;
   // Headers that are included in every response
   HTTPHeaders _defaultHeaders;
+  // Statistics about the admission of new clients
+  uint32_t _evictedConnectionCount;
+  // An evicted connection is still shutting down. Until its slot is free, no other connection is
+  // closed and no client is accepted
+  bool _evictionPending;
+  uint32_t _rejectedConnectionCount;
+  // Behavior and pre-rendered response for clients that cannot be served
+  HTTPOverloadMode _overloadMode;
+  std::string _overloadResponse;
+  // Reserved slot for a client that is rejected over several loops (-1 if unused)
+  int _rejectSocket;
+  bool _rejectWantsWrite;
+  unsigned long _rejectTS;
 
   // Setup functions
   virtual uint8_t setupSocket();
   virtual void teardownSocket();
+  void setupWakeupSocket();
 
   // Helper functions
+  virtual HTTPConnection * newConnection();
   virtual int createConnection(int idx);
+  bool evictIdleConnection();
+  void rejectConnections();
+  virtual void rejectConnection(int clientSocket);
+  virtual void advanceRejection(bool timeout);
 };
 
 }
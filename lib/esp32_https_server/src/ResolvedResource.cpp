@@ -4,14 +4,10 @@ namespace httpsserver {
 
 ResolvedResource::ResolvedResource() {
   _matchingNode = NULL;
-  _params = NULL;
 }
 
 ResolvedResource::~ResolvedResource() {
-  // Delete only params, nodes are reused/server-internal
-  if (_params != NULL) {
-    delete _params;
-  }
+
 }
 
 bool ResolvedResource::didMatch() {
@@ -26,15 +22,11 @@ void ResolvedResource::setMatchingNode(HTTPNode * node) {
   _matchingNode = node;
 }
 
+/**
+ * Returns the parameters of the matching node, or NULL if there is none
+ */
 ResourceParameters * ResolvedResource::getParams() {
-  return _params;
-}
-
-void ResolvedResource::setParams(ResourceParameters * params) {
-  if (_params != NULL && _params!=params) {
-    delete _params;
-  }
-  _params = params;
+  return didMatch() ? &_params : NULL;
 }
 
 } /* namespace httpsserver */
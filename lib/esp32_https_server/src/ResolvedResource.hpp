@@ -8,6 +8,8 @@ namespace httpsserver {
 
 /**
  * \brief This class represents a resolved resource, meaning the result of mapping a string URL to an HTTPNode
+ *
+ * The parameters are part of the object, so resolving a URL does not allocate them.
  */
 class ResolvedResource {
 public:
@@ -18,11 +20,11 @@ public:
   HTTPNode * getMatchingNode();
   bool didMatch();
   ResourceParameters * getParams();
-  void setParams(ResourceParameters * params);
 
 private:
+  friend class ResourceResolver;
   HTTPNode * _matchingNode;
-  ResourceParameters * _params;
+  ResourceParameters _params;
 };
 
 } /* namespace httpsserver */
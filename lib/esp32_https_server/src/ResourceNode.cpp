@@ -1,5 +1,7 @@
 #include "ResourceNode.hpp"
 
+#include <algorithm>
+
 namespace httpsserver {
 
 ResourceNode::ResourceNode(const std::string &path, const std::string &method, const HTTPSCallbackFunction * callback, const std::string &tag):
@@ -13,4 +15,16 @@ ResourceNode::~ResourceNode() {
   
 }
 
+void ResourceNode::addMiddleware(const HTTPSMiddlewareFunction * mwFunction) {
+  _middleware.push_back(mwFunction);
+}
+
+void ResourceNode::removeMiddleware(const HTTPSMiddlewareFunction * mwFunction) {
+  _middleware.erase(std::remove(_middleware.begin(), _middleware.end(), mwFunction), _middleware.end());
+}
+
+const std::vector<const HTTPSMiddlewareFunction*> & ResourceNode::getMiddleware() {
+  return _middleware;
+}
+
 } /* namespace httpsserver */
@@ -5,6 +5,7 @@
 
 #include "HTTPNode.hpp"
 #include "HTTPSCallbackFunction.hpp"
+#include "HTTPMiddlewareFunction.hpp"
 
 namespace httpsserver {
 
@@ -21,6 +22,16 @@ public:
   const std::string _method;
   const HTTPSCallbackFunction * _callback;
   std::string getMethod() { return _method; }
+
+  /** Add a middleware function that is only called for this node, after the global middleware. */
+  void addMiddleware(const HTTPSMiddlewareFunction * mwFunction);
+  /** Remove a specific function from the middleware chain of this node. */
+  void removeMiddleware(const HTTPSMiddlewareFunction * mwFunction);
+  /** Get the middleware functions of this node */
+  const std::vector<const HTTPSMiddlewareFunction*> & getMiddleware();
+
+private:
+  std::vector<const HTTPSMiddlewareFunction*> _middleware;
 };
 
 } /* namespace httpsserver */
@@ -4,7 +4,10 @@
 namespace httpsserver {
 
 ResourceParameters::ResourceParameters() {
-
+  _query = NULL;
+  _queryLength = 0;
+  _queryParamsDecoded = false;
+  _pathParamCount = 0;
 }
 
 ResourceParameters::~ResourceParameters() {
@@ -22,12 +25,8 @@ ResourceParameters::~ResourceParameters() {
  * @return true iff the parameter exists
  */
 bool ResourceParameters::isQueryParameterSet(std::string const &name) {
-  for(auto queryParam = _queryParams.begin(); queryParam != _queryParams.end(); ++queryParam) {
-    if ((*queryParam).first.compare(name)==0) {
-      return true;
-    }
-  }
-  return false;
+  QuerySlice slice;
+  return findQuerySlice(name, slice);
 }
 
 /**
@@ -46,15 +45,45 @@ bool ResourceParameters::isQueryParameterSet(std::string const &name) {
  * @return true iff the parameter exists and the corresponding value has been written.
  */
 bool ResourceParameters::getQueryParameter(std::string const &name, std::string &value) {
-  for(auto queryParam = _queryParams.begin(); queryParam != _queryParams.end(); ++queryParam) {
-    if ((*queryParam).first.compare(name)==0) {
-      value=(*queryParam).second;
-      return true;
-    }
+  QuerySlice slice;
+  if (findQuerySlice(name, slice)) {
+    value = urlDecode(std::string(_query + slice.valueOffset, slice.valueLength));
+    return true;
   }
   return false;
 }
 
+/**
+ * @brief Returns an HTTP query parameter as unsigned number.
+ *
+ * The value is parsed directly from the request string, without copying it. If the parameter
+ * exists multiple times, the first occurence is used.
+ *
+ * @param name The name of the parameter to retrieve
+ * @param value The target to write the number to, if the parameter exists and is valid.
+ * @return true iff the parameter exists and its value is a decimal number that fits into 32 bits.
+ */
+bool ResourceParameters::getQueryParameterUInt(std::string const &name, uint32_t &value) {
+  QuerySlice slice;
+  if (!findQuerySlice(name, slice) || slice.valueLength == 0) {
+    return false;
+  }
+  uint32_t result = 0;
+  for(size_t i = 0; i < slice.valueLength; i++) {
+    char c = _query[slice.valueOffset + i];
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    uint32_t digit = c - '0';
+    if (result > (0xFFFFFFFFu - digit) / 10) {
+      return false;
+    }
+    result = result * 10 + digit;
+  }
+  value = result;
+  return true;
+}
+
 /**
  * @brief Returns the number of query parameters.
  * 
@@ -66,8 +95,15 @@ bool ResourceParameters::getQueryParameter(std::string const &name, std::string
  */
 size_t ResourceParameters::getQueryParameterCount(bool unique) {
   if (!unique) {
-    return _queryParams.size();
+    size_t count = 0;
+    size_t pos = 0;
+    QuerySlice slice;
+    while (nextQuerySlice(pos, slice)) {
+      count++;
+    }
+    return count;
   }
+  decodeQueryParameters();
   size_t count = 0;
   for(auto a = _queryParams.begin(); a != _queryParams.end(); ++a) {
     bool exists = false;
@@ -96,6 +132,7 @@ size_t ResourceParameters::getQueryParameterCount(bool unique) {
  * @return Iterator over std::pairs of std::strings that represent (key, value) pairs
  */
 std::vector<std::pair<std::string,std::string>>::iterator ResourceParameters::beginQueryParameters() {
+  decodeQueryParameters();
   return _queryParams.begin();
 }
 
@@ -103,14 +140,88 @@ std::vector<std::pair<std::string,std::string>>::iterator ResourceParameters::be
  * @brief Counterpart to beginQueryParameters() for iterating over query parameters
  */
 std::vector<std::pair<std::string,std::string>>::iterator ResourceParameters::endQueryParameters() {
+  decodeQueryParameters();
   return _queryParams.end();
 }
 
-void ResourceParameters::setQueryParameter(std::string const &name, std::string const &value) {
-  std::pair<std::string, std::string> param;
-  param.first = name;
-  param.second = value;
-  _queryParams.push_back(param);
+/**
+ * Sets the query string of the request, without the question mark. The data is not copied, so it has
+ * to stay valid as long as this object is used.
+ */
+void ResourceParameters::setQueryString(const char * query, size_t length) {
+  _query = query;
+  _queryLength = length;
+  _queryParams.clear();
+  _queryParamsDecoded = false;
+}
+
+/**
+ * Finds the next "name=value" pair in the query string, starting at pos. Empty pairs (like in
+ * "a=1&&b=2") are skipped. Returns false if there are no more pairs.
+ */
+bool ResourceParameters::nextQuerySlice(size_t &pos, QuerySlice &slice) {
+  while (pos < _queryLength) {
+    size_t start = pos;
+    while (pos < _queryLength && _query[pos] != '&') {
+      pos++;
+    }
+    size_t end = pos;
+    // Skip the '&'
+    pos++;
+    if (end > start) {
+      size_t split = start;
+      while (split < end && _query[split] != '=') {
+        split++;
+      }
+      slice.nameOffset = start;
+      slice.nameLength = split - start;
+      // Use empty string if only name is set. /foo?bar&baz=1 will return "" for bar
+      slice.valueOffset = split < end ? split + 1 : end;
+      slice.valueLength = end - slice.valueOffset;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Finds the first pair with the given (decoded) name
+ */
+bool ResourceParameters::findQuerySlice(std::string const &name, QuerySlice &slice) {
+  size_t pos = 0;
+  while (nextQuerySlice(pos, slice)) {
+    if (queryNameEquals(slice, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ResourceParameters::queryNameEquals(QuerySlice const &slice, std::string const &name) {
+  const char * rawName = _query + slice.nameOffset;
+  // Most names contain no escaped characters, so they can be compared without decoding them
+  if (memchr(rawName, '%', slice.nameLength) == NULL && memchr(rawName, '+', slice.nameLength) == NULL) {
+    return name.length() == slice.nameLength && name.compare(0, std::string::npos, rawName, slice.nameLength) == 0;
+  }
+  return urlDecode(std::string(rawName, slice.nameLength)) == name;
+}
+
+/**
+ * Decodes all parameters into _queryParams, which is required for iterating over them
+ */
+void ResourceParameters::decodeQueryParameters() {
+  if (_queryParamsDecoded) {
+    return;
+  }
+  size_t pos = 0;
+  QuerySlice slice;
+  while (nextQuerySlice(pos, slice)) {
+    _queryParams.push_back(std::pair<std::string, std::string>(
+      urlDecode(std::string(_query + slice.nameOffset, slice.nameLength)),
+      urlDecode(std::string(_query + slice.valueOffset, slice.valueLength))
+    ));
+  }
+  _queryParamsDecoded = true;
 }
 
 /**
@@ -127,7 +238,7 @@ void ResourceParameters::setQueryParameter(std::string const &name, std::string
  * @return true iff the value could be written.
  */
 bool ResourceParameters::getPathParameter(size_t const idx, std::string &value) {
-  if (idx < _pathParams.size()) {
+  if (idx < _pathParamCount) {
     value = _pathParams.at(idx);
     return true;
   }
@@ -147,21 +258,30 @@ bool ResourceParameters::getPathParameter(size_t const idx, std::string &value)
  * @return the value of the placeholder
  */
 std::string ResourceParameters::getPathParameter(size_t const idx) {
-  if (idx < _pathParams.size()) {
+  if (idx < _pathParamCount) {
     return _pathParams.at(idx);
   }
   return "";
 }
 
 void ResourceParameters::resetPathParameters() {
-  _pathParams.clear();
+  _pathParamCount = 0;
 }
 
-void ResourceParameters::setPathParameter(size_t idx, std::string const &val) {
+/**
+ * Sets a path parameter from its URL-encoded value in the request string. The string of the
+ * previous request is reused, so no memory is allocated once it is large enough.
+ */
+void ResourceParameters::setPathParameter(size_t idx, const char * value, size_t length) {
   if(idx>=_pathParams.size()) {
     _pathParams.resize(idx + 1);
   }
-  _pathParams.at(idx) = val;
+  std::string &param = _pathParams[idx];
+  param.assign(value, length);
+  urlDecodeInPlace(param);
+  if (idx >= _pathParamCount) {
+    _pathParamCount = idx + 1;
+  }
 }
 
 } /* namespace httpsserver */
@@ -26,7 +26,8 @@ class ResourceResolver;
  * 
  * Query parameters are the key-value pairs after a question mark which can be added
  * to each request, either by specifying them manually or as result of submitting an
- * HTML form with a GET as method property.
+ * HTML form with a GET as method property. They are read directly from the request
+ * string when they are accessed, and only the requested values are decoded.
  */
 class ResourceParameters {
 public:
@@ -35,6 +36,7 @@ public:
 
   bool isQueryParameterSet(std::string const &name);
   bool getQueryParameter(std::string const &name, std::string &value);
+  bool getQueryParameterUInt(std::string const &name, uint32_t &value);
   std::vector<std::pair<std::string,std::string>>::iterator beginQueryParameters();
   std::vector<std::pair<std::string,std::string>>::iterator endQueryParameters();
   size_t getQueryParameterCount(bool unique=false);
@@ -43,15 +45,35 @@ public:
 
 protected:
   friend class ResourceResolver;
-  void setQueryParameter(std::string const &name, std::string const &value);
+  friend class StaticRouteDispatcher;
+  void setQueryString(const char * query, size_t length);
   void resetPathParameters();
-  void setPathParameter(size_t idx, std::string const &val);
+  void setPathParameter(size_t idx, const char * value, size_t length);
 
 private:
-  /** Parameters in the path of the URL, the actual values for asterisk placeholders */
+  /** Parameters in the path of the URL, the actual values for asterisk placeholders. The strings
+   * are kept when the parameters are reset, so that they can be reused for the next request */
   std::vector<std::string> _pathParams;
-  /** HTTP Query parameters, as key-value pairs */
+  /** Number of path parameters that belong to the current request */
+  size_t _pathParamCount;
+  /** The query string (after the question mark), points into the request string of the connection */
+  const char * _query;
+  size_t _queryLength;
+  /** HTTP Query parameters, as decoded key-value pairs. Only filled when iterating over them */
   std::vector<std::pair<std::string, std::string>> _queryParams;
+  bool _queryParamsDecoded;
+
+  /** Position of a single "name=value" pair in _query */
+  struct QuerySlice {
+    size_t nameOffset;
+    size_t nameLength;
+    size_t valueOffset;
+    size_t valueLength;
+  };
+  bool nextQuerySlice(size_t &pos, QuerySlice &slice);
+  bool findQuerySlice(std::string const &name, QuerySlice &slice);
+  bool queryNameEquals(QuerySlice const &slice, std::string const &name);
+  void decodeQueryParameters();
 };
 
 } /* namespace httpsserver */
@@ -3,161 +3,200 @@
 namespace httpsserver {
 
 ResourceResolver::ResourceResolver() {
-  _nodes = new std::vector<HTTPNode *>();
+  _routeTree = new RouteTreeNode("");
   _defaultNode = NULL;
+  _staticRoutes = NULL;
 }
 
 ResourceResolver::~ResourceResolver() {
-  delete _nodes;
+  delete _routeTree;
+}
+
+ResourceResolver::RouteTreeNode::RouteTreeNode(const std::string &prefix):
+  _prefix(prefix),
+  _paramChild(NULL) {
+
+}
+
+ResourceResolver::RouteTreeNode::~RouteTreeNode() {
+  for(std::vector<RouteTreeNode*>::iterator child = _children.begin(); child != _children.end(); ++child) {
+    delete *child;
+  }
+  delete _paramChild;
 }
 
 /**
  * This method will register the HTTPSNode so it is reachable and its callback gets called for a request
  */
 void ResourceResolver::registerNode(HTTPNode *node) {
-  _nodes->push_back(node);
+  RouteTreeNode * treeNode = insertPath(_routeTree, node->_path, 0);
+  treeNode->_handlers.push_back(node);
 }
 
 /**
  * This method can be used to deactivate a HTTPSNode that has been registered previously
  */
 void ResourceResolver::unregisterNode(HTTPNode *node) {
+  // The tree itself is kept, it will be reused if the path is registered again
+  removeHandler(_routeTree, node);
+}
+
+/**
+ * Returns the tree node for path[pathIdx..], starting at treeNode. Missing nodes are created, and
+ * existing edges are split if the path leaves them in the middle.
+ */
+ResourceResolver::RouteTreeNode * ResourceResolver::insertPath(RouteTreeNode * treeNode, const std::string &path, size_t pathIdx) {
+  while (pathIdx < path.length()) {
+    if (path[pathIdx] == '*') {
+      if (treeNode->_paramChild == NULL) {
+        treeNode->_paramChild = new RouteTreeNode("");
+      }
+      treeNode = treeNode->_paramChild;
+      pathIdx += 1;
+      continue;
+    }
+
+    // The static part runs up to the next parameter
+    size_t staticEnd = path.find('*', pathIdx);
+    if (staticEnd == std::string::npos) {
+      staticEnd = path.length();
+    }
+
+    RouteTreeNode * child = NULL;
+    for(std::vector<RouteTreeNode*>::iterator it = treeNode->_children.begin(); it != treeNode->_children.end(); ++it) {
+      if ((*it)->_prefix[0] == path[pathIdx]) {
+        child = *it;
+        break;
+      }
+    }
+
+    if (child == NULL) {
+      child = new RouteTreeNode(path.substr(pathIdx, staticEnd - pathIdx));
+      treeNode->_children.push_back(child);
+      treeNode = child;
+      pathIdx = staticEnd;
+      continue;
+    }
+
+    // Length of the prefix that the path and the edge have in common
+    size_t common = 0;
+    while (common < child->_prefix.length() && pathIdx + common < staticEnd &&
+        child->_prefix[common] == path[pathIdx + common]) {
+      common++;
+    }
+
+    if (common < child->_prefix.length()) {
+      // Split the edge, so that the common prefix gets its own node
+      RouteTreeNode * split = new RouteTreeNode(child->_prefix.substr(0, common));
+      child->_prefix.erase(0, common);
+      split->_children.push_back(child);
+      std::replace(treeNode->_children.begin(), treeNode->_children.end(), child, split);
+      child = split;
+    }
+
+    treeNode = child;
+    pathIdx += common;
+  }
+  return treeNode;
+}
+
+/**
+ * Finds the HTTPNode for url[inputIdx..pathEnd], starting at treeNode. Static children are tried
+ * first, the parameter child only if they did not lead to a match. The values of the parameters are
+ * only set for the path that actually matched.
+ */
+HTTPNode * ResourceResolver::matchPath(RouteTreeNode * treeNode, const std::string &method, HTTPNodeType nodeType,
+    const std::string &url, size_t inputIdx, size_t pathEnd, size_t paramIdx, ResourceParameters * params) {
+  if (inputIdx == pathEnd) {
+    for(std::vector<HTTPNode*>::iterator itNode = treeNode->_handlers.begin(); itNode != treeNode->_handlers.end(); ++itNode) {
+      HTTPNode * node = *itNode;
+      if (node->_nodeType == nodeType && (
+        // For handler functions, check the method declared with the node
+        (node->_nodeType==HANDLER_CALLBACK && ((ResourceNode*)node)->_method == method) ||
+        // For websockets, the specification says that GET is the only choice
+        (node->_nodeType==WEBSOCKET && method=="GET")
+      )) {
+        return node;
+      }
+    }
+  } else {
+    for(std::vector<RouteTreeNode*>::iterator it = treeNode->_children.begin(); it != treeNode->_children.end(); ++it) {
+      RouteTreeNode * child = *it;
+      if (child->_prefix[0] == url[inputIdx]) {
+        size_t prefixLength = child->_prefix.length();
+        if (prefixLength <= pathEnd - inputIdx && url.compare(inputIdx, prefixLength, child->_prefix) == 0) {
+          HTTPNode * node = matchPath(child, method, nodeType, url, inputIdx + prefixLength, pathEnd, paramIdx, params);
+          if (node != NULL) {
+            return node;
+          }
+        }
+        // Only one child can start with that character
+        break;
+      }
+    }
+  }
+
+  if (treeNode->_paramChild != NULL) {
+    // A parameter consumes everything up to the next slash (might be "")
+    size_t paramEnd = url.find('/', inputIdx);
+    if (paramEnd == std::string::npos || paramEnd > pathEnd) {
+      paramEnd = pathEnd;
+    }
+    HTTPNode * node = matchPath(treeNode->_paramChild, method, nodeType, url, paramEnd, pathEnd, paramIdx + 1, params);
+    if (node != NULL) {
+      params->setPathParameter(paramIdx, url.data() + inputIdx, paramEnd - inputIdx);
+      return node;
+    }
+  }
+
+  return NULL;
+}
 
+void ResourceResolver::removeHandler(RouteTreeNode * treeNode, HTTPNode * node) {
+  treeNode->_handlers.erase(std::remove(treeNode->_handlers.begin(), treeNode->_handlers.end(), node), treeNode->_handlers.end());
+  for(std::vector<RouteTreeNode*>::iterator child = treeNode->_children.begin(); child != treeNode->_children.end(); ++child) {
+    removeHandler(*child, node);
+  }
+  if (treeNode->_paramChild != NULL) {
+    removeHandler(treeNode->_paramChild, node);
+  }
 }
 
 void ResourceResolver::resolveNode(const std::string &method, const std::string &url, ResolvedResource &resolvedResource, HTTPNodeType nodeType) {
-  // Reset the resource
+  // Reset the resource. The parameters are stored in it and only valid while it is matched
   resolvedResource.setMatchingNode(NULL);
-  resolvedResource.setParams(NULL);
-
-  // Memory management of this object will be performed by the ResolvedResource instance
-  ResourceParameters * params = new ResourceParameters();
+  ResourceParameters * params = &resolvedResource._params;
+  params->setQueryString(NULL, 0);
+  params->resetPathParameters();
 
   // Split URL in resource name and request params. Request params start after an optional '?'
   size_t reqparamIdx = url.find('?');
   // Store this index to stop path parsing there
   size_t pathEnd = reqparamIdx != std::string::npos ? reqparamIdx : url.size();
 
-  // If no '?' is contained in url, 0:npos will return the string as it is
-  std::string resourceName = url.substr(0, reqparamIdx);
-
-  // Set request params in params object if a '?' exists
+  // The query parameters are only parsed when the handler accesses them
   if (reqparamIdx != std::string::npos) {
-    do {
-      // Drop the '?' or '&'
-      reqparamIdx += 1;
-
-      // Parameters are separated by '&'
-      size_t nextparamIdx = url.find('&', reqparamIdx);
-
-      // Get the "name=value" string
-      std::string param = nextparamIdx == std::string::npos ?
-         url.substr(reqparamIdx) :
-         url.substr(reqparamIdx, nextparamIdx - reqparamIdx);
-
-      if (param.length() > 0) {
-        // Find the position where the string has to be split
-        size_t nvSplitIdx = param.find('=');
-
-        // Use empty string if only name is set. /foo?bar&baz=1 will return "" for bar
-        std::string name  = urlDecode(param.substr(0, nvSplitIdx));
-        std::string value = "";
-        if (nvSplitIdx != std::string::npos) {
-          value = urlDecode(param.substr(nvSplitIdx+1));
-        }
-
-        // Now we finally have name and value.
-        params->setQueryParameter(name, value);
-      }
-
-      // Update reqparamIdx
-      reqparamIdx = nextparamIdx;
-
-    } while(reqparamIdx != std::string::npos);
+    params->setQueryString(url.data() + reqparamIdx + 1, url.length() - reqparamIdx - 1);
   }
 
-
-  // Check whether a resource matches
-
-  for(std::vector<HTTPNode*>::iterator itNode = _nodes->begin(); itNode != _nodes->end(); ++itNode) {
-    params->resetPathParameters();
-    HTTPNode *node = *itNode;
-    if (node->_nodeType==nodeType) {
-      if (
-        // For handler functions, check the method declared with the node
-        (node->_nodeType==HANDLER_CALLBACK && ((ResourceNode*)node)->_method == method) ||
-        // For websockets, the specification says that GET is the only choice
-        (node->_nodeType==WEBSOCKET && method=="GET")
-      ) {
-        HTTPS_LOGD("Testing route %s", node->_path.c_str());
-        bool match = true;
-        size_t paramCount = node->getPathParamCount();
-        // indices in input and pattern
-        size_t inputIdx = 0, pathIdx = 0;
-        HTTPS_LOGD("(INIT) inputIdx: %d, pathIdx: %d, pathEnd: %d, path: %s, url: %s",
-          inputIdx, pathIdx, pathEnd, node->_path.c_str(), url.c_str());
-
-        for (size_t paramIdx = 0; match && paramIdx < paramCount; paramIdx += 1) {
-          HTTPS_LOGD("(LOOP) inputIdx: %d, pathIdx: %d, pathEnd: %d, path: %s, url: %s",
-            inputIdx, pathIdx, pathEnd, node->_path.c_str(), url.c_str());
-          // Test static path before the parameter
-          size_t paramPos = node->getParamIdx(paramIdx);
-          size_t staticLength = paramPos - pathIdx;
-          match &= url.substr(inputIdx, staticLength) == node->_path.substr(pathIdx, staticLength);
-          inputIdx += staticLength;
-          pathIdx += staticLength;
-
-          // Extract parameter value
-          if (match) {
-            size_t paramEnd = url.find('/', inputIdx);
-            if (paramEnd == std::string::npos && inputIdx <= pathEnd) {
-              // Consume the remaining input (might be "" for the last param)
-              paramEnd = pathEnd;
-            }
-            if (paramEnd != std::string::npos) {
-              size_t paramLength = paramEnd - inputIdx;
-              params->setPathParameter(paramIdx, urlDecode(url.substr(inputIdx, paramLength)));
-              pathIdx += 1;
-              inputIdx += paramLength;
-            } else {
-              match = false;
-              HTTPS_LOGD("(LOOP) No match on param part");
-            }
-          } else {
-            HTTPS_LOGD("(LOOP) No match on static part");
-          }
-        }
-        HTTPS_LOGD("(STTC) inputIdx: %d, pathIdx: %d, pathEnd: %d, path: %s, url: %s",
-          inputIdx, pathIdx, pathEnd, node->_path.c_str(), url.c_str());
-        // Test static path after the parameter (up to pathEnd)
-        if (match) {
-          match = url.substr(inputIdx, pathEnd - inputIdx)==node->_path.substr(pathIdx);
-        }
-        HTTPS_LOGD("(END ) inputIdx: %d, pathIdx: %d, pathEnd: %d, path: %s, url: %s",
-          inputIdx, pathIdx, pathEnd, node->_path.c_str(), url.c_str());
-
-        if (match) {
-          resolvedResource.setMatchingNode(node);
-          HTTPS_LOGD("It's a match!");
-          break;
-        }
-      } // method check
-    } // node type check
-  } // resource node for loop
+  // Check whether a resource matches. Static routes only contain handler functions
+  HTTPNode * node = NULL;
+  if (_staticRoutes != NULL && nodeType == HANDLER_CALLBACK) {
+    node = _staticRoutes->resolve(method, url, pathEnd, params);
+  }
+  if (node == NULL) {
+    node = matchPath(_routeTree, method, nodeType, url, 0, pathEnd, 0, params);
+  }
+  if (node != NULL) {
+    resolvedResource.setMatchingNode(node);
+    HTTPS_LOGD("It's a match!");
+  }
 
   // If the resource did not match, configure the default resource
   if (!resolvedResource.didMatch() && _defaultNode != NULL) {
     params->resetPathParameters();
     resolvedResource.setMatchingNode(_defaultNode);
   }
-
-  // If resolving did work, set the params, otherwise delete them
-  if (resolvedResource.didMatch()) {
-    // The resolvedResource now takes care of memory management for the params
-    resolvedResource.setParams(params);
-  } else {
-    delete params;
-  }
 }
 
 void ResourceResolver::addMiddleware(const HTTPSMiddlewareFunction * mwFunction) {
@@ -168,7 +207,7 @@ void ResourceResolver::removeMiddleware(const HTTPSMiddlewareFunction * mwFuncti
   _middleware.erase(std::remove(_middleware.begin(), _middleware.end(), mwFunction), _middleware.end());
 }
 
-const std::vector<HTTPSMiddlewareFunction*> ResourceResolver::getMiddleware() {
+const std::vector<const HTTPSMiddlewareFunction*> & ResourceResolver::getMiddleware() {
   return _middleware;
 }
 
@@ -176,4 +215,12 @@ void ResourceResolver::setDefaultNode(HTTPNode * defaultNode) {
   _defaultNode = defaultNode;
 }
 
+/**
+ * Uses routes that have been defined at compile time (see StaticRouteTable). They are checked before
+ * the nodes that have been registered with registerNode().
+ */
+void ResourceResolver::setStaticRoutes(StaticRouteDispatcher * staticRoutes) {
+  _staticRoutes = staticRoutes;
+}
+
 }
@@ -12,12 +12,19 @@
 #include "WebsocketNode.hpp"
 #include "ResourceNode.hpp"
 #include "ResolvedResource.hpp"
+#include "StaticRouteTable.hpp"
 #include "HTTPMiddlewareFunction.hpp"
 
 namespace httpsserver {
 
 /**
  * \brief This class is used internally to resolve a string URL to the corresponding HTTPNode
+ *
+ * The registered nodes are stored in a radix tree that is built from their paths. Each edge of the
+ * tree is labeled with a static part of a path, or represents a path parameter (*). Resolving a URL
+ * only walks down the tree once, so its cost depends on the length of the URL and not on the number
+ * of registered nodes. Static parts take precedence over parameters, and nodes that are registered
+ * first take precedence over later nodes with the same path and method.
  */
 class ResourceResolver {
 public:
@@ -27,20 +34,45 @@ public:
   void registerNode(HTTPNode *node);
   void unregisterNode(HTTPNode *node);
   void setDefaultNode(HTTPNode *node);
+  void setStaticRoutes(StaticRouteDispatcher * staticRoutes);
   void resolveNode(const std::string &method, const std::string &url, ResolvedResource &resolvedResource, HTTPNodeType nodeType);
 
   /** Add a middleware function to the end of the middleware function chain. See HTTPSMiddlewareFunction.hpp for details. */
   void addMiddleware(const HTTPSMiddlewareFunction * mwFunction);
   /** Remove a specific function from the middleware function chain. */
   void removeMiddleware(const HTTPSMiddlewareFunction * mwFunction);
-  /** Get the current middleware chain with a resource function at the end */
-  const std::vector<HTTPSMiddlewareFunction*> getMiddleware();
+  /** Get the current global middleware chain */
+  const std::vector<const HTTPSMiddlewareFunction*> & getMiddleware();
 
 private:
 
-  // This vector holds all nodes (with callbacks) that are registered
-  std::vector<HTTPNode*> * _nodes;
+  /**
+   * \brief Node of the radix tree
+   */
+  struct RouteTreeNode {
+    RouteTreeNode(const std::string &prefix);
+    ~RouteTreeNode();
+
+    // Static part of the path that leads to this node (empty for the root and parameters)
+    std::string _prefix;
+    // Children with static prefixes. No two of them start with the same character
+    std::vector<RouteTreeNode*> _children;
+    // Child for a path parameter, or NULL
+    RouteTreeNode * _paramChild;
+    // All HTTPNodes whose path ends here, for the different methods and node types
+    std::vector<HTTPNode*> _handlers;
+  };
+
+  RouteTreeNode * insertPath(RouteTreeNode * treeNode, const std::string &path, size_t pathIdx);
+  HTTPNode * matchPath(RouteTreeNode * treeNode, const std::string &method, HTTPNodeType nodeType,
+    const std::string &url, size_t inputIdx, size_t pathEnd, size_t paramIdx, ResourceParameters * params);
+  void removeHandler(RouteTreeNode * treeNode, HTTPNode * node);
+
+  // Root of the tree that holds all nodes (with callbacks) that are registered
+  RouteTreeNode * _routeTree;
   HTTPNode * _defaultNode;
+  // Routes that have been defined at compile time, if any
+  StaticRouteDispatcher * _staticRoutes;
 
   // Middleware functions, if any are registered. Will be called in order of the vector.
   std::vector<const HTTPSMiddlewareFunction*> _middleware;
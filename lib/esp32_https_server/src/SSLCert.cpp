@@ -2,11 +2,12 @@
 
 namespace httpsserver {
 
-SSLCert::SSLCert(unsigned char * certData, uint16_t certLength, unsigned char * pkData, uint16_t pkLength):
+SSLCert::SSLCert(unsigned char * certData, uint16_t certLength, unsigned char * pkData, uint16_t pkLength, SSLKeyType pkType):
   _certLength(certLength),
   _certData(certData),
   _pkLength(pkLength),
-  _pkData(pkData) {
+  _pkData(pkData),
+  _pkType(pkType) {
 
 }
 
@@ -31,9 +32,14 @@ unsigned char * SSLCert::getPKData() {
   return _pkData;
 }
 
-void SSLCert::setPK(unsigned char * pkData, uint16_t length) {
+SSLKeyType SSLCert::getPKType() {
+  return _pkType;
+}
+
+void SSLCert::setPK(unsigned char * pkData, uint16_t length, SSLKeyType type) {
   _pkData = pkData;
   _pkLength = length;
+  _pkType = type;
 }
 
 void SSLCert::setCert(unsigned char * certData, uint16_t length) {
@@ -79,9 +85,10 @@ static int gen_key(SSLCert &certCtx, SSLKeySize keySize) {
   }
 
   // Initialize the private key
+  bool isEC = (keySize == KEYSIZE_EC_P256);
   mbedtls_pk_context key;
   mbedtls_pk_init( &key );
-  int resPkSetup = mbedtls_pk_setup( &key, mbedtls_pk_info_from_type( MBEDTLS_PK_RSA ) );
+  int resPkSetup = mbedtls_pk_setup( &key, mbedtls_pk_info_from_type( isEC ? MBEDTLS_PK_ECKEY : MBEDTLS_PK_RSA ) );
   if ( resPkSetup != 0) {
     mbedtls_ctr_drbg_free( &ctr_drbg );
     mbedtls_entropy_free( &entropy );
@@ -89,13 +96,23 @@ static int gen_key(SSLCert &certCtx, SSLKeySize keySize) {
   }
 
   // Actual key generation 
-  int resPkGen = mbedtls_rsa_gen_key(
-    mbedtls_pk_rsa( key ),
-    mbedtls_ctr_drbg_random,
-    &ctr_drbg,
-    keySize,
-    65537
-  );
+  int resPkGen;
+  if (isEC) {
+    resPkGen = mbedtls_ecp_gen_key(
+      MBEDTLS_ECP_DP_SECP256R1,
+      mbedtls_pk_ec( key ),
+      mbedtls_ctr_drbg_random,
+      &ctr_drbg
+    );
+  } else {
+    resPkGen = mbedtls_rsa_gen_key(
+      mbedtls_pk_rsa( key ),
+      mbedtls_ctr_drbg_random,
+      &ctr_drbg,
+      keySize,
+      65537
+    );
+  }
   if ( resPkGen != 0) {
     mbedtls_pk_free( &key );
     mbedtls_ctr_drbg_free( &ctr_drbg );
@@ -139,7 +156,7 @@ static int gen_key(SSLCert &certCtx, SSLKeySize keySize) {
   mbedtls_pk_free( &key );
 
   // Set the private key in the context
-  certCtx.setPK(output_pk, pkLength);
+  certCtx.setPK(output_pk, pkLength, isEC ? KEYTYPE_EC : KEYTYPE_RSA);
 
   return 0;
 }
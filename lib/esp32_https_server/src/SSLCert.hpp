@@ -9,6 +9,7 @@
 #include <mbedtls/entropy.h>
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/pk.h>
+#include <mbedtls/ecp.h>
 #include <mbedtls/x509.h>
 #include <mbedtls/x509_crt.h>
 #include <mbedtls/x509_csr.h>
@@ -32,6 +33,16 @@
 
 namespace httpsserver {
 
+/**
+ * \brief Defines the type of the private key of an SSLCert
+ */
+enum SSLKeyType {
+  /** \brief RSA key (PKCS#1 DER) */
+  KEYTYPE_RSA,
+  /** \brief ECDSA key (SEC1 DER) */
+  KEYTYPE_EC
+};
+
 /**
   * \brief Certificate and private key that can be passed to the HTTPSServer.
   * 
@@ -47,6 +58,8 @@ namespace httpsserver {
   * openssl rsa -inform PEM -outform DER -in myCert.key -out key.der
   * ```
   * 
+  * For an ECDSA key, use `openssl ec` instead of `openssl rsa` and pass KEYTYPE_EC as key type.
+  * 
   * **Converting DER File to C Header**
   * 
   * ```bash
@@ -71,12 +84,14 @@ public:
    * \param[in] certLength The length of the certificate data
    * \param[in] pkData The private key data to use (DER format)
    * \param[in] pkLength The length of the private key
+   * \param[in] pkType The type of the private key
    */
   SSLCert(
     unsigned char * certData = NULL,
     uint16_t certLength = 0,
     unsigned char * pkData = NULL,
-    uint16_t pkLength = 0
+    uint16_t pkLength = 0,
+    SSLKeyType pkType = KEYTYPE_RSA
   );
   virtual ~SSLCert();
 
@@ -100,6 +115,11 @@ public:
    */
   unsigned char * getPKData();
 
+  /**
+   * \brief Returns the type of the private key
+   */
+  SSLKeyType getPKType();
+
   /**
    * \brief Sets the private key in DER format
    * 
@@ -110,8 +130,9 @@ public:
    * 
    * \param[in] _pkData The data of the private key
    * \param[in] length The length of the private key
+   * \param[in] type The type of the private key
    */
-  void setPK(unsigned char * _pkData, uint16_t length);
+  void setPK(unsigned char * _pkData, uint16_t length, SSLKeyType type = KEYTYPE_RSA);
 
   /**
    * \brief Sets the certificate data in DER format
@@ -136,6 +157,7 @@ private:
   unsigned char * _certData;
   uint16_t _pkLength;
   unsigned char * _pkData;
+  SSLKeyType _pkType;
 
 };
 
@@ -152,7 +174,9 @@ enum SSLKeySize {
   /** \brief RSA key with 2048 bit */
   KEYSIZE_2048 = 2048,
   /** \brief RSA key with 4096 bit */
-  KEYSIZE_4096 = 4096
+  KEYSIZE_4096 = 4096,
+  /** \brief ECDSA key on the NIST P-256 curve (secp256r1). Generated a lot faster than RSA keys */
+  KEYSIZE_EC_P256 = 256
 };
 
 /**
@@ -169,7 +193,8 @@ enum SSLKeySize {
  * "20190101000000", "20300101000000"
  * 
  * This will take some time, so you should probably write the certificate data to non-volatile
- * storage when you are done.
+ * storage when you are done. For KEYSIZE_EC_P256, an ECDSA key is used, which takes less than a
+ * second to generate and leads to a faster handshake.
  * 
  * Setting the `HTTPS_DISABLE_SELFSIGNING` compiler flag will remove this function from the library
  */
@@ -0,0 +1,54 @@
+#include "SSLPlatform.hpp"
+
+namespace httpsserver {
+
+#if HTTPS_SSL_PLATFORM_ACCESS
+
+/**
+ * Does what SSL_accept() does before it runs the handshake (ssl_pm_reload_crt() in ssl_pm.c): The
+ * certificate and the key of the SSL object are passed to its mbedtls configuration. The copy that
+ * SSL_new() creates only references the objects of the SSL_CTX, so these are used as a fallback.
+ *
+ * The server never requests client certificates, so the CA chain and the verify mode of the SSL
+ * object are not transferred.
+ *
+ * Returns false if there is no certificate or it could not be set.
+ */
+bool prepareSSLPlatformHandshake(SSL * ssl) {
+  if (ssl == NULL || ssl->ssl_pm == NULL || ssl->cert == NULL || ssl->cert->x509 == NULL || ssl->cert->pkey == NULL) {
+    return false;
+  }
+  SSLPlatformCertMirror * certPm = static_cast<SSLPlatformCertMirror*>(ssl->cert->x509->x509_pm);
+  SSLPlatformKeyMirror * keyPm = static_cast<SSLPlatformKeyMirror*>(ssl->cert->pkey->pkey_pm);
+  if (certPm == NULL || keyPm == NULL) {
+    return false;
+  }
+
+  mbedtls_ssl_config * conf = getSSLPlatformConfig(ssl);
+  if (certPm->x509_crt && keyPm->pkey) {
+    return mbedtls_ssl_conf_own_cert(conf, certPm->x509_crt, keyPm->pkey) == 0;
+  } else if (certPm->ex_crt && keyPm->ex_pkey) {
+    return mbedtls_ssl_conf_own_cert(conf, certPm->ex_crt, keyPm->ex_pkey) == 0;
+  }
+  return false;
+}
+
+/**
+ * Advances the handshake of the SSL object as far as possible without waiting for the socket. Unlike
+ * SSL_accept(), which repeats the handshake until it is done, this returns MBEDTLS_ERR_SSL_WANT_READ
+ * or MBEDTLS_ERR_SSL_WANT_WRITE if the socket is non-blocking and not ready.
+ *
+ * Returns 0 once the handshake is done, or another mbedtls error code if it failed.
+ */
+int stepSSLPlatformHandshake(SSL * ssl) {
+  mbedtls_ssl_context * ctx = getSSLPlatformContext(ssl);
+  int res = 0;
+  while (res == 0 && ctx->state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    res = mbedtls_ssl_handshake_step(ctx);
+  }
+  return res;
+}
+
+#endif
+
+} /* namespace httpsserver */
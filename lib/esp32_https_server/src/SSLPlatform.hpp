@@ -0,0 +1,92 @@
+#ifndef SRC_SSLPLATFORM_HPP_
+#define SRC_SSLPLATFORM_HPP_
+
+#include <Arduino.h>
+
+// Required for SSL
+#include "openssl/ssl.h"
+#undef read
+
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+#include <mbedtls/pk.h>
+
+#if defined(__has_include)
+#if __has_include(<esp_idf_version.h>)
+#include <esp_idf_version.h>
+#endif
+#endif
+
+/**
+ * The OpenSSL compatibility layer of the esp-idf keeps the mbedtls objects of each SSL object in a
+ * private struct behind SSL::ssl_pm (struct ssl_pm in components/openssl/platform/ssl_pm.c). Its
+ * layout has been verified for the esp-idf releases 4.0 to 4.4; the layer has been removed in 5.0.
+ * On any other version, HTTPS_SSL_PLATFORM_ACCESS is 0 and the features that need the mbedtls
+ * objects (session resumption, the non-blocking handshake) are disabled. The handshake is
+ * then done with a blocking SSL_accept().
+ */
+#if defined(ESP_IDF_VERSION) && defined(ESP_IDF_VERSION_VAL)
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 0, 0) && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+#define HTTPS_SSL_PLATFORM_ACCESS 1
+#endif
+#endif
+
+#ifndef HTTPS_SSL_PLATFORM_ACCESS
+#define HTTPS_SSL_PLATFORM_ACCESS 0
+#endif
+
+namespace httpsserver {
+
+#if HTTPS_SSL_PLATFORM_ACCESS
+
+/**
+ * Mirror of the beginning of struct ssl_pm
+ */
+struct SSLPlatformMirror {
+  mbedtls_net_context fd;
+  mbedtls_net_context cl_fd;
+  mbedtls_ssl_config conf;
+  mbedtls_ctr_drbg_context ctr_drbg;
+  mbedtls_ssl_context ssl;
+};
+
+/**
+ * Mirror of struct x509_pm, behind X509::x509_pm
+ */
+struct SSLPlatformCertMirror {
+  mbedtls_x509_crt * x509_crt;
+  mbedtls_x509_crt * ex_crt;
+};
+
+/**
+ * Mirror of struct pkey_pm, behind EVP_PKEY::pkey_pm
+ */
+struct SSLPlatformKeyMirror {
+  mbedtls_pk_context * pkey;
+  mbedtls_pk_context * ex_pkey;
+};
+
+/**
+ * Returns the mbedtls configuration that is used for the given SSL object only
+ */
+inline mbedtls_ssl_config * getSSLPlatformConfig(SSL * ssl) {
+  return &(static_cast<SSLPlatformMirror*>(ssl->ssl_pm)->conf);
+}
+
+/**
+ * Returns the mbedtls context that performs the handshake and the record layer of the SSL object
+ */
+inline mbedtls_ssl_context * getSSLPlatformContext(SSL * ssl) {
+  return &(static_cast<SSLPlatformMirror*>(ssl->ssl_pm)->ssl);
+}
+
+bool prepareSSLPlatformHandshake(SSL * ssl);
+int stepSSLPlatformHandshake(SSL * ssl);
+
+#endif
+
+} /* namespace httpsserver */
+
+#endif /* SRC_SSLPLATFORM_HPP_ */
@@ -0,0 +1,160 @@
+#include "SSLSessionCache.hpp"
+
+#include "SSLPlatform.hpp"
+
+namespace httpsserver {
+
+SSLSessionCache::SSLSessionCache(uint16_t maxEntries, uint32_t ticketLifetime):
+  _maxEntries(maxEntries),
+  _ticketLifetime(ticketLifetime) {
+  _active = false;
+  _handshakeCount = 0;
+  _resumedCount = 0;
+}
+
+SSLSessionCache::~SSLSessionCache() {
+  teardown();
+}
+
+/**
+ * Initializes the session cache and generates the first ticket key. Returns false if the random
+ * number generator or the ticket key could not be set up, or if the mbedtls configuration of the
+ * connections cannot be accessed on this esp-idf version (see SSLPlatform.hpp).
+ */
+bool SSLSessionCache::setup() {
+  if (_active) {
+    return true;
+  }
+#if !HTTPS_SSL_PLATFORM_ACCESS
+  // The OpenSSL layer does not support session caching on its own. The callbacks have to be added
+  // to the mbedtls configuration of each connection, which is only possible for known layouts.
+  return false;
+#else
+
+  mbedtls_entropy_init(&_entropy);
+  mbedtls_ctr_drbg_init(&_ctrDrbg);
+#ifdef MBEDTLS_SSL_CACHE_C
+  mbedtls_ssl_cache_init(&_cache);
+  mbedtls_ssl_cache_set_max_entries(&_cache, _maxEntries);
+  mbedtls_ssl_cache_set_timeout(&_cache, HTTPS_SESSION_TIMEOUT);
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+  mbedtls_ssl_ticket_init(&_ticket);
+#endif
+  _active = true;
+
+  const char * pers = "esp32-tls-session";
+  if (mbedtls_ctr_drbg_seed(&_ctrDrbg, mbedtls_entropy_func, &_entropy, (const unsigned char *)pers, strlen(pers)) != 0) {
+    HTTPS_LOGE("Could not seed RNG for session tickets");
+    teardown();
+    return false;
+  }
+
+#ifdef MBEDTLS_SSL_TICKET_C
+  // mbedtls rotates the key on its own when the lifetime has passed
+  if (_ticketLifetime > 0 && mbedtls_ssl_ticket_setup(&_ticket, mbedtls_ctr_drbg_random, &_ctrDrbg,
+      MBEDTLS_CIPHER_AES_256_GCM, _ticketLifetime) != 0) {
+    HTTPS_LOGE("Could not set up session ticket key");
+    teardown();
+    return false;
+  }
+#endif
+
+  return true;
+#endif
+}
+
+/**
+ * Discards all stored sessions and ticket keys
+ */
+void SSLSessionCache::teardown() {
+  if (_active) {
+#ifdef MBEDTLS_SSL_TICKET_C
+    mbedtls_ssl_ticket_free(&_ticket);
+#endif
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_free(&_cache);
+#endif
+    mbedtls_ctr_drbg_free(&_ctrDrbg);
+    mbedtls_entropy_free(&_entropy);
+    _active = false;
+  }
+}
+
+/**
+ * Enables session resumption for a new connection. Must be called after SSL_new() and before the
+ * handshake starts.
+ */
+void SSLSessionCache::attach(SSL * ssl) {
+#if HTTPS_SSL_PLATFORM_ACCESS
+  if (!_active || ssl == NULL || ssl->ssl_pm == NULL) {
+    return;
+  }
+  mbedtls_ssl_config * conf = getSSLPlatformConfig(ssl);
+#ifdef MBEDTLS_SSL_CACHE_C
+  if (_maxEntries > 0) {
+    mbedtls_ssl_conf_session_cache(conf, this, &SSLSessionCache::cacheGet, &SSLSessionCache::cacheSet);
+  }
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+  if (_ticketLifetime > 0) {
+    mbedtls_ssl_conf_session_tickets_cb(conf, &SSLSessionCache::ticketWrite, &SSLSessionCache::ticketParse, this);
+  }
+#endif
+#endif
+}
+
+/**
+ * Has to be called for every successful handshake, to keep track of the full handshakes
+ */
+void SSLSessionCache::handshakeDone() {
+  _handshakeCount++;
+}
+
+/**
+ * Returns the number of handshakes in which a previous session has been resumed
+ */
+uint32_t SSLSessionCache::getResumedHandshakeCount() {
+  return _resumedCount;
+}
+
+/**
+ * Returns the number of handshakes that required a full key exchange
+ */
+uint32_t SSLSessionCache::getFullHandshakeCount() {
+  // A resumption that fails later in the handshake has been counted, but not the handshake
+  return _handshakeCount > _resumedCount ? _handshakeCount - _resumedCount : 0;
+}
+
+#ifdef MBEDTLS_SSL_CACHE_C
+int SSLSessionCache::cacheGet(void * data, mbedtls_ssl_session * session) {
+  SSLSessionCache * sessionCache = static_cast<SSLSessionCache*>(data);
+  int res = mbedtls_ssl_cache_get(&sessionCache->_cache, session);
+  if (res == 0) {
+    sessionCache->_resumedCount++;
+  }
+  return res;
+}
+
+int SSLSessionCache::cacheSet(void * data, const mbedtls_ssl_session * session) {
+  return mbedtls_ssl_cache_set(&static_cast<SSLSessionCache*>(data)->_cache, session);
+}
+#endif
+
+#ifdef MBEDTLS_SSL_TICKET_C
+int SSLSessionCache::ticketWrite(void * data, const mbedtls_ssl_session * session, unsigned char * start,
+    const unsigned char * end, size_t * tlen, uint32_t * lifetime) {
+  return mbedtls_ssl_ticket_write(&static_cast<SSLSessionCache*>(data)->_ticket, session, start, end, tlen, lifetime);
+}
+
+int SSLSessionCache::ticketParse(void * data, mbedtls_ssl_session * session, unsigned char * buf, size_t len) {
+  SSLSessionCache * sessionCache = static_cast<SSLSessionCache*>(data);
+  int res = mbedtls_ssl_ticket_parse(&sessionCache->_ticket, session, buf, len);
+  if (res == 0) {
+    sessionCache->_resumedCount++;
+  }
+  return res;
+}
+#endif
+
+} /* namespace httpsserver */
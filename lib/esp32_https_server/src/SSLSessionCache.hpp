@@ -0,0 +1,79 @@
+#ifndef SRC_SSLSESSIONCACHE_HPP_
+#define SRC_SSLSESSIONCACHE_HPP_
+
+#include <Arduino.h>
+
+// Required for SSL
+#include "openssl/ssl.h"
+#undef read
+
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#ifdef MBEDTLS_SSL_CACHE_C
+#include <mbedtls/ssl_cache.h>
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+#include <mbedtls/ssl_ticket.h>
+#endif
+
+#include "HTTPSServerConstants.hpp"
+
+namespace httpsserver {
+
+/**
+ * \brief Server-side storage that allows clients to resume previous TLS sessions
+ *
+ * Resuming a session skips the key exchange, which makes reconnecting a lot faster than a full
+ * handshake. Two mechanisms are supported:
+ *
+ * - A bounded cache of session IDs, kept in RAM
+ * - Stateless session tickets, encrypted with a key that is rotated regularly
+ *
+ * Each of them can be disabled by passing 0 to the constructor. If the underlying mbedtls has been
+ * built without MBEDTLS_SSL_CACHE_C or MBEDTLS_SSL_TICKET_C, the respective mechanism is not available.
+ */
+class SSLSessionCache {
+public:
+  SSLSessionCache(uint16_t maxEntries = HTTPS_SESSION_CACHE_SIZE, uint32_t ticketLifetime = HTTPS_SESSION_TICKET_LIFETIME);
+  virtual ~SSLSessionCache();
+
+  bool setup();
+  void teardown();
+  void attach(SSL * ssl);
+  void handshakeDone();
+
+  uint32_t getResumedHandshakeCount();
+  uint32_t getFullHandshakeCount();
+
+private:
+  // Configuration
+  uint16_t _maxEntries;
+  uint32_t _ticketLifetime;
+  bool _active;
+
+  // Statistics
+  uint32_t _handshakeCount;
+  uint32_t _resumedCount;
+
+  // The ticket keys are generated randomly
+  mbedtls_entropy_context _entropy;
+  mbedtls_ctr_drbg_context _ctrDrbg;
+
+#ifdef MBEDTLS_SSL_CACHE_C
+  mbedtls_ssl_cache_context _cache;
+  static int cacheGet(void * data, mbedtls_ssl_session * session);
+  static int cacheSet(void * data, const mbedtls_ssl_session * session);
+#endif
+
+#ifdef MBEDTLS_SSL_TICKET_C
+  mbedtls_ssl_ticket_context _ticket;
+  static int ticketWrite(void * data, const mbedtls_ssl_session * session, unsigned char * start,
+    const unsigned char * end, size_t * tlen, uint32_t * lifetime);
+  static int ticketParse(void * data, mbedtls_ssl_session * session, unsigned char * buf, size_t len);
+#endif
+};
+
+} /* namespace httpsserver */
+
+#endif /* SRC_SSLSESSIONCACHE_HPP_ */
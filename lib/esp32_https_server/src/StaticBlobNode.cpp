@@ -0,0 +1,40 @@
+#include "StaticBlobNode.hpp"
+
+namespace httpsserver {
+
+StaticBlobNode::StaticBlobNode(const std::string &path, const StaticBlob &blob, const std::string &tag):
+  ResourceNode(path, "GET", &StaticBlobNode::handleRequest, tag),
+  _blob(blob) {
+
+}
+
+StaticBlobNode::~StaticBlobNode() {
+
+}
+
+/**
+ * The callback of every StaticBlobNode, so the resolved node is always a StaticBlobNode
+ */
+void StaticBlobNode::handleRequest(HTTPRequest * req, HTTPResponse * res) {
+  const StaticBlob &blob = static_cast<StaticBlobNode*>(req->getResolvedNode())->_blob;
+  HTTPHeaders * headers = req->getHTTPHeaders();
+
+  if (headers->valueContains(HEADER_IF_NONE_MATCH, blob.etag) || headers->valueEquals(HEADER_IF_NONE_MATCH, "*")) {
+    res->sendPrerendered(blob.notModifiedHead, blob.notModifiedHeadLength, NULL, 0);
+    return;
+  }
+
+  // Without Accept-Encoding, the client accepts every encoding. There is no other representation
+  // of the blob, so a client that refuses its encoding cannot be served.
+  if (blob.encoding != NULL && headers->has(HEADER_ACCEPT_ENCODING) &&
+      !headers->valueContains(HEADER_ACCEPT_ENCODING, blob.encoding)) {
+    res->setStatusCode(406);
+    res->setStatusText("Not Acceptable");
+    res->println("406 Not Acceptable");
+    return;
+  }
+
+  res->sendPrerendered(blob.head, blob.headLength, blob.body, blob.bodyLength);
+}
+
+} /* namespace httpsserver */
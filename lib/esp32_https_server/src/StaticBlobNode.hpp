@@ -0,0 +1,53 @@
+#ifndef SRC_STATICBLOBNODE_HPP_
+#define SRC_STATICBLOBNODE_HPP_
+
+#include <Arduino.h>
+#include <string>
+
+#include "ResourceNode.hpp"
+#include "HTTPRequest.hpp"
+#include "HTTPResponse.hpp"
+
+namespace httpsserver {
+
+/**
+ * \brief A response that has been rendered at build time
+ *
+ * The heads contain the status line and the headers, each terminated by CRLF, without the empty
+ * line at the end (see HTTPResponse::sendPrerendered()). All data may be stored in PROGMEM.
+ */
+struct StaticBlob {
+  /** Head of the 200 response, including Content-Type, Content-Length and ETag */
+  const char * head;
+  size_t headLength;
+  /** Head of the 304 response, including ETag and Cache-Control */
+  const char * notModifiedHead;
+  size_t notModifiedHeadLength;
+  const uint8_t * body;
+  size_t bodyLength;
+  /** Quoted ETag of the body */
+  const char * etag;
+  /** Content-Encoding of the body, or NULL if it is not encoded */
+  const char * encoding;
+};
+
+/**
+ * \brief ResourceNode that answers GET requests with a StaticBlob
+ *
+ * The response is written to the connection at once. If the client already has the blob, only
+ * the prerendered 304 head is sent.
+ */
+class StaticBlobNode : public ResourceNode {
+public:
+  StaticBlobNode(const std::string &path, const StaticBlob &blob, const std::string &tag = "");
+  virtual ~StaticBlobNode();
+
+  const StaticBlob &_blob;
+
+private:
+  static void handleRequest(HTTPRequest * req, HTTPResponse * res);
+};
+
+} /* namespace httpsserver */
+
+#endif /* SRC_STATICBLOBNODE_HPP_ */
@@ -0,0 +1,91 @@
+#include "StaticRouteTable.hpp"
+
+#include "util.hpp"
+
+namespace httpsserver {
+
+StaticRouteDispatcher::StaticRouteDispatcher(const StaticRoute * routes, size_t routeCount, uint8_t * slots, size_t slotCount,
+  uint32_t seed, StaticRouteNode * nodes):
+  _routes(routes),
+  _routeCount(routeCount),
+  _slots(slots),
+  _slotCount(slotCount),
+  _seed(seed),
+  _nodes(nodes) {
+
+}
+
+/**
+ * Fills the hash table and binds the nodes to the handlers. The slots have been checked by the
+ * compiler, so no two routes end up in the same one.
+ */
+void StaticRouteDispatcher::setup() {
+  memset(_slots, 0xFF, _slotCount);
+  for(size_t i = 0; i < _routeCount; i++) {
+    _nodes[i]._callback = _routes[i]._callback;
+    if (_routes[i]._paramCount == 0) {
+      _slots[staticRouteSlot(_routes[i]._hash, _seed, _slotCount)] = i;
+    }
+  }
+}
+
+/**
+ * Returns the node for the given request, or NULL if none of the routes matches. url[0..pathEnd]
+ * is the path of the request, without the query string.
+ */
+HTTPNode * StaticRouteDispatcher::resolve(const std::string &method, const std::string &url, size_t pathEnd, ResourceParameters * params) {
+  // Routes without parameters: Hash the request like the compiler hashed the routes
+  uint32_t hash = staticRouteHashChar(staticRouteHashString(STATIC_ROUTE_HASH_BASIS, method.c_str()), ' ');
+  for(size_t i = 0; i < pathEnd; i++) {
+    hash = staticRouteHashChar(hash, url[i]);
+  }
+  uint8_t idx = _slots[staticRouteSlot(hash, _seed, _slotCount)];
+  if (idx < _routeCount) {
+    // Other requests may end up in the same slot, so compare the route itself
+    const StaticRoute &route = _routes[idx];
+    if (method.compare(route._method) == 0 && url.compare(0, pathEnd, route._path) == 0) {
+      return &_nodes[idx];
+    }
+  }
+
+  // Routes with parameters, in the order of their definition
+  for(size_t i = 0; i < _routeCount; i++) {
+    const StaticRoute &route = _routes[i];
+    if (route._paramCount > 0 && method.compare(route._method) == 0 && matchPattern(route._path, url, pathEnd, NULL)) {
+      matchPattern(route._path, url, pathEnd, params);
+      return &_nodes[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Compares the path of the URL to a pattern with parameters. Like in the ResourceResolver, a
+ * parameter consumes everything up to the next slash. The values are only set if params is not NULL.
+ */
+bool StaticRouteDispatcher::matchPattern(const char * pattern, const std::string &url, size_t pathEnd, ResourceParameters * params) {
+  size_t inputIdx = 0;
+  size_t paramIdx = 0;
+  for(; *pattern != 0; pattern++) {
+    if (*pattern == '*') {
+      size_t paramEnd = url.find('/', inputIdx);
+      if (paramEnd == std::string::npos || paramEnd > pathEnd) {
+        paramEnd = pathEnd;
+      }
+      if (params != NULL) {
+        params->setPathParameter(paramIdx, url.data() + inputIdx, paramEnd - inputIdx);
+      }
+      paramIdx++;
+      inputIdx = paramEnd;
+    } else {
+      if (inputIdx >= pathEnd || url[inputIdx] != *pattern) {
+        return false;
+      }
+      inputIdx++;
+    }
+  }
+  return inputIdx == pathEnd;
+}
+
+} /* namespace httpsserver */
@@ -0,0 +1,174 @@
+#ifndef SRC_STATICROUTETABLE_HPP_
+#define SRC_STATICROUTETABLE_HPP_
+
+#include <Arduino.h>
+#include <string>
+
+#include "HTTPSServerConstants.hpp"
+#include "HTTPSCallbackFunction.hpp"
+#include "ResourceNode.hpp"
+#include "ResourceParameters.hpp"
+
+namespace httpsserver {
+
+// Seed of the FNV-1a hash that is used for the static routes
+#define STATIC_ROUTE_HASH_BASIS 2166136261u
+// Returned by findStaticRouteSeed() if no perfect hash could be found
+#define STATIC_ROUTE_NO_SEED    0xFFFFFFFFu
+
+constexpr uint32_t staticRouteHashChar(uint32_t hash, char c) {
+  return (hash ^ (uint8_t)c) * 16777619u;
+}
+
+constexpr uint32_t staticRouteHashString(uint32_t hash, const char * str) {
+  return *str == 0 ? hash : staticRouteHashString(staticRouteHashChar(hash, *str), str + 1);
+}
+
+/**
+ * Hash of a method and path, the same value is calculated for each request by StaticRouteDispatcher
+ */
+constexpr uint32_t staticRouteHash(const char * method, const char * path) {
+  return staticRouteHashString(staticRouteHashChar(staticRouteHashString(STATIC_ROUTE_HASH_BASIS, method), ' '), path);
+}
+
+constexpr uint8_t staticRouteParamCount(const char * path) {
+  return *path == 0 ? 0 : (*path == '*' ? 1 : 0) + staticRouteParamCount(path + 1);
+}
+
+/**
+ * \brief Definition of a route that is known at compile time
+ *
+ * Arrays of StaticRoute can be declared constexpr, so that the hash of each route is calculated by
+ * the compiler. The handler has to be a plain function, as lambdas cannot be used in constant
+ * expressions before C++17. Paths may contain * for parameters, like the path of a ResourceNode.
+ */
+struct StaticRoute {
+  constexpr StaticRoute(const char * method, const char * path, HTTPSCallbackFunction * callback):
+    _method(method),
+    _path(path),
+    _callback(callback),
+    _hash(staticRouteHash(method, path)),
+    _paramCount(staticRouteParamCount(path)) {}
+
+  const char * const _method;
+  const char * const _path;
+  HTTPSCallbackFunction * const _callback;
+  const uint32_t _hash;
+  const uint8_t _paramCount;
+};
+
+/**
+ * Returns the slot of a route hash in a table with the given number of slots (a power of two)
+ */
+constexpr size_t staticRouteSlot(uint32_t hash, uint32_t seed, size_t slots) {
+  return (((hash ^ seed) * 2654435761u) >> 16) & (slots - 1);
+}
+
+/**
+ * Returns the number of slots for a table with the given number of routes. The table is kept
+ * sparse, so that a perfect hash is found after a few seeds.
+ */
+constexpr size_t staticRouteSlots(size_t routeCount, size_t slots = 8) {
+  return slots >= routeCount * routeCount / 2 ? slots : staticRouteSlots(routeCount, slots * 2);
+}
+
+constexpr bool staticRouteCollidesWith(const StaticRoute * routes, size_t count, size_t slots, uint32_t seed, size_t i, size_t j) {
+  return j >= count ? false :
+    (routes[j]._paramCount == 0 &&
+      staticRouteSlot(routes[i]._hash, seed, slots) == staticRouteSlot(routes[j]._hash, seed, slots)) ||
+    staticRouteCollidesWith(routes, count, slots, seed, i, j + 1);
+}
+
+constexpr bool staticRouteCollides(const StaticRoute * routes, size_t count, size_t slots, uint32_t seed, size_t i = 0) {
+  return i >= count ? false :
+    (routes[i]._paramCount == 0 && staticRouteCollidesWith(routes, count, slots, seed, i, i + 1)) ||
+    staticRouteCollides(routes, count, slots, seed, i + 1);
+}
+
+/**
+ * Searches for a seed that maps all routes without parameters to different slots
+ */
+constexpr uint32_t findStaticRouteSeed(const StaticRoute * routes, size_t count, size_t slots, uint32_t seed = 0) {
+  return seed >= HTTPS_STATIC_ROUTE_MAX_SEEDS ? STATIC_ROUTE_NO_SEED :
+    (!staticRouteCollides(routes, count, slots, seed) ? seed : findStaticRouteSeed(routes, count, slots, seed + 1));
+}
+
+/**
+ * \brief HTTPNode that is used for the routes of a StaticRouteTable
+ *
+ * All of its strings are empty, so creating it does not allocate memory.
+ */
+class StaticRouteNode : public ResourceNode {
+public:
+  StaticRouteNode(): ResourceNode("", "", NULL) {}
+};
+
+/**
+ * \brief Resolves requests to the routes of a StaticRouteTable
+ *
+ * Routes without parameters are found with a single lookup in a perfect hash table, routes with
+ * parameters are compared to the URL in place. Use the StaticRouteTable template to create an
+ * instance and register it with HTTPServer::setStaticRoutes().
+ */
+class StaticRouteDispatcher {
+public:
+  HTTPNode * resolve(const std::string &method, const std::string &url, size_t pathEnd, ResourceParameters * params);
+
+protected:
+  StaticRouteDispatcher(const StaticRoute * routes, size_t routeCount, uint8_t * slots, size_t slotCount,
+    uint32_t seed, StaticRouteNode * nodes);
+  void setup();
+
+private:
+  bool matchPattern(const char * pattern, const std::string &url, size_t pathEnd, ResourceParameters * params);
+
+  const StaticRoute * _routes;
+  size_t _routeCount;
+  uint8_t * _slots;
+  size_t _slotCount;
+  uint32_t _seed;
+  StaticRouteNode * _nodes;
+};
+
+/**
+ * \brief Storage for a StaticRouteDispatcher. Use the STATIC_ROUTE_TABLE macro to declare it.
+ *
+ * Example:
+ *
+ *   constexpr StaticRoute routes[] = {
+ *     StaticRoute("GET", "/api/uptime", &handleGetUptime),
+ *     StaticRoute("POST", "/api/events", &handlePostEvent)
+ *   };
+ *   STATIC_ROUTE_TABLE(routes) routeTable(routes);
+ *
+ *   server.setStaticRoutes(&routeTable);
+ */
+template<size_t RouteCount, size_t SlotCount, uint32_t Seed>
+class StaticRouteTable : public StaticRouteDispatcher {
+  static_assert(RouteCount < 0xFF, "A StaticRouteTable supports up to 254 routes");
+  static_assert(Seed != STATIC_ROUTE_NO_SEED, "No perfect hash found for the routes, increase HTTPS_STATIC_ROUTE_MAX_SEEDS");
+public:
+  StaticRouteTable(const StaticRoute (&routes)[RouteCount]):
+    StaticRouteDispatcher(routes, RouteCount, _slotStorage, SlotCount, Seed, _nodeStorage) {
+    setup();
+  }
+
+private:
+  uint8_t _slotStorage[SlotCount];
+  StaticRouteNode _nodeStorage[RouteCount];
+};
+
+} /* namespace httpsserver */
+
+/**
+ * Type of the StaticRouteTable for a constexpr array of StaticRoute. The perfect hash is searched
+ * by the compiler.
+ */
+#define STATIC_ROUTE_TABLE(routes) \
+  httpsserver::StaticRouteTable< \
+    sizeof(routes) / sizeof(routes[0]), \
+    httpsserver::staticRouteSlots(sizeof(routes) / sizeof(routes[0])), \
+    httpsserver::findStaticRouteSeed(routes, sizeof(routes) / sizeof(routes[0]), \
+      httpsserver::staticRouteSlots(sizeof(routes) / sizeof(routes[0])))>
+
+#endif /* SRC_STATICROUTETABLE_HPP_ */
@@ -60,6 +60,11 @@ std::string intToString(int i) {
 }
 
 std::string urlDecode(std::string input) {
+  urlDecodeInPlace(input);
+  return input;
+}
+
+void urlDecodeInPlace(std::string &input) {
   std::size_t idxReplaced = 0;
   // First replace + by space
   std::size_t idxFound = input.find('+');
@@ -94,5 +99,4 @@ std::string urlDecode(std::string input) {
     idxReplaced = idxFound + 1;
     idxFound = input.find('%', idxReplaced);
   }
-  return input;
 }
@@ -32,4 +32,9 @@ std::string intToString(int i);
  */
 std::string urlDecode(std::string input);
 
+/**
+ * \brief **Utility function**: Removes URL encoding from the string in place, without allocating memory
+ */
+void urlDecodeInPlace(std::string &input);
+
 #endif /* SRC_UTIL_HPP_ */
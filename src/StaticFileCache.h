@@ -0,0 +1,247 @@
+#ifndef STATIC_FILE_CACHE_H
+#define STATIC_FILE_CACHE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include <list>
+#include <string>
+
+// Size of the file contents that are kept in memory, depending on whether PSRAM is available
+#define STATIC_CACHE_BUDGET_PSRAM (1024 * 1024)
+#define STATIC_CACHE_BUDGET_RAM   (32 * 1024)
+
+// Number of paths that are remembered as not found
+#define STATIC_CACHE_NOT_FOUND_ENTRIES 16
+
+/**
+ * Headers of the response for a static file, as they are determined by handleLittleFS()
+ */
+struct StaticFileInfo {
+  StaticFileInfo():
+    contentType(NULL),
+    encoding(NULL),
+    cacheControl(NULL),
+    hasVariants(false) {
+    lastModified[0] = 0;
+  }
+
+  std::string etag;
+  char lastModified[32];
+  const char * contentType;
+  const char * encoding;
+  const char * cacheControl;
+  bool hasVariants;
+};
+
+/**
+ * A static file in the cache. The requested path and the encodings that the client accepts (one
+ * bit per encoding) decide which file is sent, so both of them are the key.
+ */
+struct StaticFileCacheEntry {
+  std::string path;
+  uint8_t acceptedEncodings;
+  StaticFileInfo info;
+  uint8_t * data;
+  size_t size;
+};
+
+/**
+ * LRU cache for the content of small static files, so that frequent requests do not have to access
+ * LittleFS. It also remembers the paths that recently resulted in a 404.
+ *
+ * The content is stored in PSRAM if the module has it. Files that change have to be reported with
+ * invalidate().
+ */
+class StaticFileCache {
+public:
+  StaticFileCache():
+    _usePSRAM(false),
+    _budget(0),
+    _used(0),
+    _hits(0),
+    _misses(0),
+    _notFoundHits(0) {
+  }
+
+  ~StaticFileCache() {
+    clear();
+  }
+
+  /**
+   * Sets the budget of the cache, depending on the available memory
+   */
+  void begin() {
+    _usePSRAM = psramFound();
+    _budget = _usePSRAM ? STATIC_CACHE_BUDGET_PSRAM : STATIC_CACHE_BUDGET_RAM;
+  }
+
+  /**
+   * Returns the cached file for the request and marks it as recently used. If the file is not in
+   * the cache, NULL is returned and notFound tells whether the path recently resulted in a 404.
+   */
+  StaticFileCacheEntry * lookup(const std::string &path, uint8_t acceptedEncodings, bool &notFound) {
+    notFound = false;
+    for(std::list<StaticFileCacheEntry>::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+      if (it->acceptedEncodings == acceptedEncodings && it->path == path) {
+        _entries.splice(_entries.begin(), _entries, it);
+        _hits++;
+        return &_entries.front();
+      }
+    }
+    for(std::list<NotFoundEntry>::iterator it = _notFound.begin(); it != _notFound.end(); ++it) {
+      if (it->acceptedEncodings == acceptedEncodings && it->path == path) {
+        _notFound.splice(_notFound.begin(), _notFound, it);
+        _notFoundHits++;
+        notFound = true;
+        return NULL;
+      }
+    }
+    _misses++;
+    return NULL;
+  }
+
+  /**
+   * Reads the file into the cache. Returns NULL if the file is too large for the cache or could
+   * not be read, in which case it has to be sent from the file system.
+   */
+  StaticFileCacheEntry * insert(const std::string &path, uint8_t acceptedEncodings, const StaticFileInfo &info, File &file) {
+    size_t size = file.size();
+    if (size > getMaxFileSize()) {
+      return NULL;
+    }
+    while (!_entries.empty() && _used + size > _budget) {
+      evict();
+    }
+    // malloc(0) may return NULL, but an empty file has to be cached as well
+    uint8_t * data = (uint8_t*)(_usePSRAM ? ps_malloc(size > 0 ? size : 1) : malloc(size > 0 ? size : 1));
+    if (data == NULL) {
+      return NULL;
+    }
+    if (file.read(data, size) != size) {
+      free(data);
+      return NULL;
+    }
+
+    StaticFileCacheEntry entry;
+    entry.path = path;
+    entry.acceptedEncodings = acceptedEncodings;
+    entry.info = info;
+    entry.data = data;
+    entry.size = size;
+    _entries.push_front(entry);
+    _used += size;
+    return &_entries.front();
+  }
+
+  /**
+   * Remembers that the path resulted in a 404 for clients that accept the given encodings
+   */
+  void insertNotFound(const std::string &path, uint8_t acceptedEncodings) {
+    if (_notFound.size() >= STATIC_CACHE_NOT_FOUND_ENTRIES) {
+      _notFound.pop_back();
+    }
+    NotFoundEntry entry;
+    entry.path = path;
+    entry.acceptedEncodings = acceptedEncodings;
+    _notFound.push_front(entry);
+  }
+
+  /**
+   * Removes all entries that may be affected by a change of the file at the given path. This
+   * includes the entries of the original file if path is one of its variants, like "/app.js.gz".
+   */
+  void invalidate(const std::string &path) {
+    for(std::list<StaticFileCacheEntry>::iterator it = _entries.begin(); it != _entries.end();) {
+      if (isAffectedBy(it->path, path)) {
+        _used -= it->size;
+        free(it->data);
+        it = _entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for(std::list<NotFoundEntry>::iterator it = _notFound.begin(); it != _notFound.end();) {
+      if (isAffectedBy(it->path, path)) {
+        it = _notFound.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void clear() {
+    while (!_entries.empty()) {
+      evict();
+    }
+    _notFound.clear();
+  }
+
+  /**
+   * Files that are larger than this are not cached, so that a single file cannot displace all others
+   */
+  size_t getMaxFileSize() {
+    return _budget / 4;
+  }
+
+  size_t getBudget() {
+    return _budget;
+  }
+
+  size_t getUsedBytes() {
+    return _used;
+  }
+
+  size_t getEntryCount() {
+    return _entries.size();
+  }
+
+  uint32_t getHitCount() {
+    return _hits;
+  }
+
+  uint32_t getMissCount() {
+    return _misses;
+  }
+
+  uint32_t getNotFoundHitCount() {
+    return _notFoundHits;
+  }
+
+private:
+  struct NotFoundEntry {
+    std::string path;
+    uint8_t acceptedEncodings;
+  };
+
+  /**
+   * Removes the least recently used file
+   */
+  void evict() {
+    _used -= _entries.back().size;
+    free(_entries.back().data);
+    _entries.pop_back();
+  }
+
+  /**
+   * An entry is affected by a change of its own file and of every file whose name continues with
+   * an extension, which covers the precompressed variants
+   */
+  static bool isAffectedBy(const std::string &entryPath, const std::string &changedPath) {
+    return changedPath.compare(0, entryPath.length(), entryPath) == 0 &&
+      (changedPath.length() == entryPath.length() || changedPath[entryPath.length()] == '.');
+  }
+
+  bool _usePSRAM;
+  size_t _budget;
+  size_t _used;
+  uint32_t _hits;
+  uint32_t _misses;
+  uint32_t _notFoundHits;
+
+  // Most recently used entries first
+  std::list<StaticFileCacheEntry> _entries;
+  std::list<NotFoundEntry> _notFound;
+};
+
+#endif /* STATIC_FILE_CACHE_H */
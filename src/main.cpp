@@ -91,10 +91,24 @@
 
 // Working with c++ strings
 #include <string>
+#include <map>
+
+// We use stat() to check static files without opening them
+#include <sys/stat.h>
 
 // Define the name of the directory for public files in the SPIFFS parition
 #define DIR_PUBLIC "/public"
 
+// Directory for the ETags of the uploaded files in DIR_PUBLIC, one sidecar file per file
+#define DIR_ETAGS "/etags"
+
+// Mount point of LittleFS in the virtual file system, used for stat()
+#define LITTLEFS_BASE_PATH "/littlefs"
+
+// Modification times before 2020 mean that the clock had not been set when the file was written,
+// so they are not sent as Last-Modified
+#define MIN_VALID_MTIME 1577836800
+
 // We need to specify some content-type mapping, so the resources get delivered with the
 // right content type and are displayed correctly in the browser
 char contentTypes[][2][32] = {
@@ -107,6 +121,14 @@ char contentTypes[][2][32] = {
   {"", ""}
 };
 
+// Cache-Control for the static files, by prefix of the requested path. The first match is used.
+// Files in /assets have a fingerprint in their name, so they never change. Everything else has to
+// be revalidated, which costs a 304 response if the file did not change.
+const char * cacheControlRules[][2] = {
+  {"/assets/", "public, max-age=31536000, immutable"},
+  {"/",        "no-cache"}
+};
+
 // Includes for the server
 #include <HTTPSServer.hpp>
 #include <SSLCert.hpp>
@@ -114,136 +136,15 @@ char contentTypes[][2][32] = {
 #include <HTTPResponse.hpp>
 #include <util.hpp>
 
-// The HTTPS Server comes in a separate namespace. For easier use, include it here.
-using namespace httpsserver;
+// The HTML pages in assets/, bundled by tools/bundle_assets.py
+#include <assets_bundle.h>
 
+// Cache for the static files in RAM or PSRAM
+#include "StaticFileCache.h"
+StaticFileCache staticFileCache;
 
-/**
- * Simple HTML page for uploading a file to the ESP32 server
- * Save this as /public/upload.html in your LittleFS data folder
- */
-const char upload_html[] PROGMEM = R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-  <meta charset="UTF-8">
-  <title>Upload File</title>
-</head>
-<body>
-  <h2>Upload File to ESP32</h2>
-  <form id="uploadForm" enctype="multipart/form-data" method="post" action="/api/upload">
-    <input type="file" name="file" required>
-    <button type="submit">Upload</button>
-  </form>
-  <div id="result"></div>
-  <div>
-    <label for="folderSelect">Select folder:</label>
-    <select id="folderSelect" onchange="listFiles()">
-      <option value="/public">/public</option>
-    </select>
-    <button onclick="listFiles()">Refresh File List</button>
-  </div>
-  <div id="listFiles">
-    <h3>Files</h3>
-    <ul id="fileList"></ul>
-  </div>
-  <div id="Usege">
-    <h3>Usage</h3>
-    <p id="memoryUsage"></p>
-  </div>
-  <script>
-    document.addEventListener('DOMContentLoaded', function() {
-      listFiles();
-      getMemoryUsage();
-    });
-
-    document.getElementById('uploadForm').onsubmit = async function(e) {
-      e.preventDefault();
-      const form = e.target;
-      const data = new FormData(form);
-      const resultDiv = document.getElementById('result');
-      resultDiv.textContent = "Uploading...";
-      try {
-        const res = await fetch(form.action, {
-          method: 'POST',
-          body: data
-        });
-        const text = await res.text();
-        resultDiv.textContent = text;
-        listFiles();
-      } catch (err) {
-        resultDiv.textContent = "Upload failed: " + err;
-      }
-    };
-
-    async function listFiles() {
-      const fileList = document.getElementById('fileList');
-      fileList.innerHTML = '';
-      const folder = document.getElementById('folderSelect').value;
-      try {
-        const res = await fetch('/api/fs/list?dir=' + folder);
-        if (!res.ok) throw new Error('Network response was not ok');
-        const files = await res.json();
-        files.forEach(file => {
-          const li = document.createElement('li');
-          li.textContent = `${file.name} (${file.size} bytes)`;
-          if (file.isDir) {
-            const btn = document.createElement('button');
-            btn.textContent = 'Open';
-            btn.onclick = function() {
-              setFolder(file.name);
-            };
-            li.appendChild(btn);
-          } else {
-            const link = document.createElement('a');
-            link.href = file.name;
-            link.textContent = ' [Download]';
-            link.target = '_blank';
-            li.appendChild(link);
-          }
-          fileList.appendChild(li);
-        });
-      } catch (err) {
-        console.error('Error fetching file list:', err);
-      }
-    }
-        // Always add /public if not present
-        if (![...select.options].some(o => o.value === 'public')) {
-          const opt = document.createElement('option');
-          opt.value = 'public';
-          opt.textContent = '/public';
-          select.appendChild(opt);
-          opt.value = '';
-          opt.textContent = '/';
-          select.appendChild(opt);
-        }
-      } catch (err) {
-        console.error('Error fetching root folders:', err);
-      }
-    }
-
-    function setFolder(folder) {
-      const select = document.getElementById('folderSelect');
-      select.value = folder;
-      listFiles();
-    }
-
-    async function getMemoryUsage() {
-      try {
-        const res = await fetch('/api/fs/usage');
-        if (!res.ok) throw new Error('Network response was not ok');
-        const data = await res.json();
-        document.getElementById('memoryUsage').textContent = 
-          `Total: ${data.totalBytes} bytes, Used: ${data.usedBytes} bytes, Free: ${data.freeBytes} bytes`;
-      } catch (err) {
-        console.error('Error fetching memory usage:', err);
-      }
-    }
-  </script>
-</body>
-</html>
-)rawliteral";
-
+// The HTTPS Server comes in a separate namespace. For easier use, include it here.
+using namespace httpsserver;
 
 
 SSLCert * getCertificate();
@@ -253,6 +154,7 @@ void handleGetEvents(HTTPRequest * req, HTTPResponse * res);
 void handlePostEvent(HTTPRequest * req, HTTPResponse * res);
 void handleDeleteEvent(HTTPRequest * req, HTTPResponse * res);
 void handleGetHistory(HTTPRequest * req, HTTPResponse * res);
+void handleGetHistoryFile(HTTPRequest * req, HTTPResponse * res);
 //handleUploadFile
 void handleUploadFile(HTTPRequest * req, HTTPResponse * res);
 // We use the following struct to store GPIO events:
@@ -282,7 +184,7 @@ void setup() {
   pinMode(13, OUTPUT);
 
   // Try to mount SPIFFS without formatting on failure
-  if (!LittleFS.begin(false)) {
+  if (!LittleFS.begin(false, LITTLEFS_BASE_PATH)) {
     // If SPIFFS does not work, we wait for serial connection...
     while(!Serial);
     delay(1000);
@@ -293,13 +195,14 @@ void setup() {
     Serial.println();
 
     // If the user did not accept to try formatting SPIFFS or formatting failed:
-    if (Serial.read() != 'y' || !LittleFS.begin(true)) {
+    if (Serial.read() != 'y' || !LittleFS.begin(true, LITTLEFS_BASE_PATH)) {
       Serial.println("LittleFS not available. Stop.");
       while(true);
     }
     Serial.println("LittleFS has been formated.");
   }
   Serial.println("LittleFS has been mounted.");
+  staticFileCache.begin();
 
   // Now that SPIFFS is ready, we can create or load the certificate
   SSLCert *cert = getCertificate();
@@ -329,6 +232,8 @@ void setup() {
 
   // Create the server with the certificate we loaded before
   secureServer = new HTTPSServer(cert);
+  // If all connections are busy, answer new clients with 503 and Retry-After instead of letting them wait
+  secureServer->setOverloadMode(OVERLOAD_RESPOND);
   WebAPI();
   Serial.println("Starting server...");
   secureServer->start();
@@ -344,8 +249,9 @@ long resetcounter = 0;
 byte DoorState = 0; // 0: Closed, 1: Open, 2: Stopped
 
 void loop() {
-  // This call will let the server do its work
-  secureServer->loop();
+  // This call will let the server do its work. While the server is idle, it sleeps until a
+  // client sends data, but at most 100ms, so that the events below are still checked regularly.
+  secureServer->loop(100);
 
   // Here we handle the events
   unsigned long now = millis() / 1000;
@@ -376,7 +282,6 @@ void loop() {
         // DoorStates();
     } 
   // Other code would go here...
-  delay(1);
 }//loop
 
 /**
@@ -384,38 +289,37 @@ void loop() {
  * create a self-signed certificate and write it to SPIFFS for next boot
  */
 SSLCert * getCertificate() {
-  // Try to open key and cert file to see if they exist
-  File keyFile = LittleFS.open("/key.der");
-  File certFile = LittleFS.open("/cert.der");
+  // Try to open key and cert file to see if they exist. The ECDSA key uses its own file name,
+  // so that an RSA key from an older firmware is replaced by a new one.
+  File keyFile = LittleFS.open("/key_ec.der");
+  File certFile = LittleFS.open("/cert_ec.der");
 
   // If not, create them 
   if (!keyFile || !certFile || keyFile.size()==0 || certFile.size()==0) {
     Serial.println("No certificate found in LittleFS, generating a new one for you.");
-    Serial.println("If you face a Guru Meditation, give the script another try (or two...).");
-    Serial.println("This may take up to a minute, so please stand by :)");
 
     SSLCert * newCert = new SSLCert();
     // The part after the CN= is the domain that this certificate will match, in this
     // case, it's esp32.local.
     // However, as the certificate is self-signed, your browser won't trust the server
     // anyway.
-    int res = createSelfSignedCert(*newCert, KEYSIZE_1024, "CN=esp32.local,O=acme,C=DE");
+    int res = createSelfSignedCert(*newCert, KEYSIZE_EC_P256, "CN=esp32.local,O=acme,C=DE");
     if (res == 0) {
       // We now have a certificate. We store it on the SPIFFS to restore it on next boot.
 
       bool failure = false;
       // Private key
-      keyFile = LittleFS.open("/key.der", FILE_WRITE);
+      keyFile = LittleFS.open("/key_ec.der", FILE_WRITE);
       if (!keyFile || !keyFile.write(newCert->getPKData(), newCert->getPKLength())) {
-        Serial.println("Could not write /key.der");
+        Serial.println("Could not write /key_ec.der");
         failure = true;
       }
       if (keyFile) keyFile.close();
 
       // Certificate
-      certFile = LittleFS.open("/cert.der", FILE_WRITE);
+      certFile = LittleFS.open("/cert_ec.der", FILE_WRITE);
       if (!certFile || !certFile.write(newCert->getCertData(), newCert->getCertLength())) {
-        Serial.println("Could not write /cert.der");
+        Serial.println("Could not write /cert_ec.der");
         failure = true;
       }
       if (certFile) certFile.close();
@@ -460,13 +364,358 @@ SSLCert * getCertificate() {
     keyFile.close();
     certFile.close();
     Serial.printf("Read %u bytes of certificate and %u bytes of key from LittleFS\n", certSize, keySize);
-    return new SSLCert(certBuffer, certSize, keyBuffer, keySize);
+    return new SSLCert(certBuffer, certSize, keyBuffer, keySize, KEYTYPE_EC);
+  }
+}
+
+/**
+ * Precompressed variants of static files, in the order of preference. A file like /public/app.js
+ * can be stored as /public/app.js.br or /public/app.js.gz next to (or instead of) the plain file.
+ */
+const char * contentEncodings[][2] = {
+  {"br",   ".br"},
+  {"gzip", ".gz"}
+};
+
+/**
+ * Strong ETag of a static file, together with the size and modification time it belongs to
+ */
+struct StaticFileTag {
+  off_t size;
+  time_t mtime;
+  std::string etag;
+};
+
+// ETags of the static files that have been requested, by file name
+std::map<std::string, StaticFileTag> staticFileTags;
+
+/**
+ * Gets size and modification time of a regular file on LittleFS without opening it
+ */
+bool statLittleFS(const std::string &filename, struct stat &st) {
+  std::string path = std::string(LITTLEFS_BASE_PATH) + filename;
+  return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+/**
+ * Continues the FNV-1a hash of a static file with the next part of its content
+ */
+uint32_t hashStaticFile(uint32_t hash, const uint8_t * data, size_t length) {
+  for(size_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
   }
+  return hash;
+}
+
+/**
+ * Creates the ETag for a static file from its size and the hash of its content
+ */
+std::string formatStaticFileETag(size_t size, uint32_t hash) {
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%lx-%08x\"", (unsigned long)size, hash);
+  return etag;
+}
+
+/**
+ * Returns the path of the sidecar file that holds the ETag of a file in DIR_PUBLIC
+ */
+std::string getStaticFileETagPath(const std::string &filename) {
+  return std::string(DIR_ETAGS) + filename.substr(strlen(DIR_PUBLIC));
+}
+
+/**
+ * Stores the ETag of a file that has just been written to DIR_PUBLIC in its sidecar file, together
+ * with the size and modification time that it belongs to
+ */
+void storeStaticFileETag(const std::string &filename, size_t size, uint32_t hash) {
+  struct stat st;
+  std::string sidecar = getStaticFileETagPath(filename);
+  staticFileTags.erase(filename);
+  if (!statLittleFS(filename, st) || (size_t)st.st_size != size) {
+    LittleFS.remove(sidecar.c_str());
+    return;
+  }
+  LittleFS.mkdir(DIR_ETAGS);
+  File file = LittleFS.open(sidecar.c_str(), FILE_WRITE);
+  if (file) {
+    file.printf("%lx %lx %s\n", (unsigned long)st.st_size, (unsigned long)st.st_mtime,
+      formatStaticFileETag(size, hash).c_str());
+    file.close();
+  }
+}
+
+/**
+ * Returns the ETag of a static file. It is based on a hash of the content, as the modification
+ * time is not reliable without a clock. The hash is calculated while the file is uploaded and kept
+ * in a sidecar file in DIR_ETAGS. Files without a valid sidecar, like the ones from the filesystem
+ * image, get an ETag from their size and modification time instead, so the file is never read here.
+ */
+std::string getStaticFileETag(const std::string &filename, const struct stat &st) {
+  std::map<std::string, StaticFileTag>::iterator it = staticFileTags.find(filename);
+  if (it != staticFileTags.end() && it->second.size == st.st_size && it->second.mtime == st.st_mtime) {
+    return it->second.etag;
+  }
+
+  StaticFileTag &tag = staticFileTags[filename];
+  tag.size = st.st_size;
+  tag.mtime = st.st_mtime;
+  tag.etag.clear();
+
+  // The sidecar is only valid for the file that it has been written for
+  File file = LittleFS.open(getStaticFileETagPath(filename).c_str());
+  if (file) {
+    char line[64];
+    size_t length = file.read((uint8_t *)line, sizeof(line) - 1);
+    line[length] = 0;
+    file.close();
+    unsigned long size, mtime;
+    char etag[24];
+    if (sscanf(line, "%lx %lx %23s", &size, &mtime, etag) == 3 &&
+        size == (unsigned long)st.st_size && mtime == (unsigned long)st.st_mtime) {
+      tag.etag = etag;
+    }
+  }
+  if (tag.etag.empty()) {
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (unsigned long)st.st_size, (unsigned long)st.st_mtime);
+    tag.etag = etag;
+  }
+  return tag.etag;
+}
+
+// Result of parsing the Range header of a request
+enum ByteRangeResult {
+  // No range, or one that is not supported (like several ranges). The whole file is sent.
+  BYTE_RANGE_NONE,
+  // A single range within the file
+  BYTE_RANGE_VALID,
+  // The range begins after the end of the file
+  BYTE_RANGE_UNSATISFIABLE
+};
+
+/**
+ * Parses the decimal number at p and moves p behind it. Returns false if there are no digits or
+ * the number does not fit into a size_t.
+ */
+bool parseRangeNumber(const char * &p, size_t &value) {
+  const char * start = p;
+  value = 0;
+  for(; *p >= '0' && *p <= '9'; p++) {
+    if (value > (SIZE_MAX - 9) / 10) {
+      return false;
+    }
+    value = value * 10 + (*p - '0');
+  }
+  return p != start;
+}
+
+/**
+ * Parses a single byte range ("bytes=100-199", "bytes=100-" or "bytes=-100") for a file of the
+ * given size into the positions of its first and last byte. They are only set for a valid range.
+ */
+ByteRangeResult parseByteRange(const std::string &range, size_t size, size_t &first, size_t &last) {
+  if (range.length() < 6 || strncasecmp(range.c_str(), "bytes=", 6) != 0 || range.find(',') != std::string::npos) {
+    return BYTE_RANGE_NONE;
+  }
+  const char * p = range.c_str() + 6;
+  while (*p == ' ') {
+    p++;
+  }
+  if (*p == '-') {
+    // Suffix range: The last bytes of the file
+    size_t suffix;
+    p++;
+    if (!parseRangeNumber(p, suffix) || *p != 0) {
+      return BYTE_RANGE_NONE;
+    }
+    if (suffix == 0 || size == 0) {
+      return BYTE_RANGE_UNSATISFIABLE;
+    }
+    first = suffix < size ? size - suffix : 0;
+    last = size - 1;
+    return BYTE_RANGE_VALID;
+  }
+  size_t start;
+  if (!parseRangeNumber(p, start) || *p != '-') {
+    return BYTE_RANGE_NONE;
+  }
+  p++;
+  size_t end = SIZE_MAX;
+  if (*p != 0 && (!parseRangeNumber(p, end) || *p != 0 || end < start)) {
+    return BYTE_RANGE_NONE;
+  }
+  if (start >= size) {
+    return BYTE_RANGE_UNSATISFIABLE;
+  }
+  first = start;
+  last = end < size ? end : size - 1;
+  return BYTE_RANGE_VALID;
+}
+
+/**
+ * Determines which part of a body of the given size is sent. If the request has a single byte
+ * range, the status is set to 206 Partial Content. With If-Range, the range only applies if the
+ * client has the current version of the file, which is identified by etag or lastModified (pass ""
+ * if the file has none). Sets the Content-Length for the part that is sent, or returns false if
+ * the response is already complete.
+ */
+bool prepareByteRange(HTTPRequest * req, HTTPResponse * res, size_t size, const char * etag, const char * lastModified,
+  size_t &first, size_t &last) {
+  first = 0;
+  last = size - 1;
+  res->setHeader("Accept-Ranges", "bytes");
+
+  HTTPHeaders * reqHeaders = req->getHTTPHeaders();
+  bool rangeApplies = reqHeaders->has(HEADER_RANGE) && (!reqHeaders->has(HEADER_IF_RANGE) ||
+    (etag[0] != 0 && reqHeaders->valueEquals(HEADER_IF_RANGE, etag)) ||
+    (lastModified[0] != 0 && reqHeaders->valueEquals(HEADER_IF_RANGE, lastModified)));
+  if (rangeApplies) {
+    ByteRangeResult range = parseByteRange(reqHeaders->getValue(HEADER_RANGE), size, first, last);
+    if (range == BYTE_RANGE_UNSATISFIABLE) {
+      res->setStatusCode(416);
+      res->setStatusText("Range Not Satisfiable");
+      res->setHeader("Content-Range", "bytes */" + httpsserver::intToString(size));
+      return false;
+    }
+    if (range == BYTE_RANGE_VALID) {
+      res->setStatusCode(206);
+      res->setStatusText("Partial Content");
+      res->setHeader("Content-Range", "bytes " + httpsserver::intToString(first) + "-" +
+        httpsserver::intToString(last) + "/" + httpsserver::intToString(size));
+    }
+  }
+  res->setHeader("Content-Length", httpsserver::intToString(size > 0 ? last - first + 1 : 0));
+  return true;
+}
+
+/**
+ * Sends an open file as the body of the response. If the request has a single byte range, only
+ * that part is sent, seeking the file to its beginning (see prepareByteRange()).
+ */
+void sendFileBody(HTTPRequest * req, HTTPResponse * res, File &file, const char * etag, const char * lastModified) {
+  size_t size = file.size();
+  size_t first, last;
+  if (!prepareByteRange(req, res, size, etag, lastModified, first, last)) {
+    return;
+  }
+  if (first > 0 && !file.seek(first)) {
+    // The status line has not been sent yet, so we can still fail properly
+    res->setStatusCode(500);
+    res->setStatusText("Internal Server Error");
+    res->setHeader("Content-Length", "0");
+    return;
+  }
+
+  // Read the file and write it to the response
+  size_t remaining = size > 0 ? last - first + 1 : 0;
+  uint8_t buffer[256];
+  while (remaining > 0) {
+    size_t length = file.read(buffer, remaining < sizeof(buffer) ? remaining : sizeof(buffer));
+    if (length == 0) {
+      break;
+    }
+    res->write(buffer, length);
+    remaining -= length;
+  }
+}
+
+/**
+ * Returns the Cache-Control value for a requested path, based on the cacheControlRules table
+ */
+const char * getCacheControl(const std::string &reqFile) {
+  for(size_t i = 0; i < sizeof(cacheControlRules) / sizeof(cacheControlRules[0]); i++) {
+    if (reqFile.compare(0, strlen(cacheControlRules[i][0]), cacheControlRules[i][0]) == 0) {
+      return cacheControlRules[i][1];
+    }
+  }
+  return "no-cache";
+}
+
+/**
+ * Content-Type is guessed using the definition of the contentTypes-table defined above. Returns
+ * NULL if the type is unknown.
+ */
+const char * getContentType(const std::string &reqFile) {
+  int cTypeIdx = 0;
+  do {
+    if(reqFile.rfind(contentTypes[cTypeIdx][0])!=std::string::npos) {
+      return contentTypes[cTypeIdx][1];
+    }
+    cTypeIdx+=1;
+  } while(strlen(contentTypes[cTypeIdx][0])>0);
+  return NULL;
+}
+
+/**
+ * Sets the headers for a static file. Returns true if the client already has the current version
+ * of the file, in which case the response is complete with 304 Not Modified.
+ */
+bool sendStaticFileHeaders(HTTPRequest * req, HTTPResponse * res, const StaticFileInfo &info) {
+  // These headers are also part of a 304 response
+  if (!info.etag.empty()) {
+    res->setHeader("ETag", info.etag);
+  }
+  if (info.lastModified[0] != 0) {
+    res->setHeader("Last-Modified", info.lastModified);
+  }
+  res->setHeader("Cache-Control", info.cacheControl);
+  if (info.hasVariants) {
+    res->setHeader("Vary", "Accept-Encoding");
+  }
+
+  // If-None-Match takes precedence over If-Modified-Since. Clients send back the date of our
+  // Last-Modified header, so it is enough to compare it as a string.
+  HTTPHeaders * reqHeaders = req->getHTTPHeaders();
+  bool notModified = false;
+  if (reqHeaders->has(HEADER_IF_NONE_MATCH)) {
+    notModified = !info.etag.empty() && (reqHeaders->valueEquals(HEADER_IF_NONE_MATCH, "*") ||
+      reqHeaders->valueContains(HEADER_IF_NONE_MATCH, info.etag.c_str()));
+  } else if (info.lastModified[0] != 0) {
+    notModified = reqHeaders->valueEquals(HEADER_IF_MODIFIED_SINCE, info.lastModified);
+  }
+  if (notModified) {
+    res->setStatusCode(304);
+    res->setStatusText("Not Modified");
+    return true;
+  }
+
+  if (info.encoding != NULL) {
+    res->setHeader("Content-Encoding", info.encoding);
+  }
+  if (info.contentType != NULL) {
+    res->setHeader("Content-Type", info.contentType);
+  }
+  return false;
+}
+
+/**
+ * Sends a static file from the cache. The body is written at once.
+ */
+void sendCachedFile(HTTPRequest * req, HTTPResponse * res, StaticFileCacheEntry * entry) {
+  if (sendStaticFileHeaders(req, res, entry->info)) {
+    return;
+  }
+  size_t first, last;
+  if (prepareByteRange(req, res, entry->size, entry->info.etag.c_str(), entry->info.lastModified, first, last) && entry->size > 0) {
+    res->write(entry->data + first, last - first + 1);
+  }
+}
+
+/**
+ * Sends "404 Not Found" for a static file
+ */
+void sendStaticFileNotFound(HTTPResponse * res) {
+  res->setStatusCode(404);
+  res->setStatusText("Not found");
+  res->println("404 Not Found");
 }
 
 /**
  * This handler function will try to load the requested resource from LittleFS's /public folder.
  * If the method is not GET, it will throw 405, if the file is not found, it will throw 404.
+ * If the client accepts it, a precompressed variant of the file is sent instead. Files come with
+ * an ETag and are answered with 304 if the client already has the current version. Single byte
+ * ranges are supported. Small files are served from the staticFileCache.
  */
 void handleLittleFS(HTTPRequest * req, HTTPResponse * res) {
   // We only handle GET here
@@ -474,40 +723,83 @@ void handleLittleFS(HTTPRequest * req, HTTPResponse * res) {
     // Redirect / to /index.html
     std::string reqFile = req->getRequestString()=="/" ? "/index.html" : req->getRequestString();
 
+    // The encodings that the client accepts decide which variant of the file is sent
+    uint8_t acceptedEncodings = 0;
+    for(size_t i = 0; i < sizeof(contentEncodings) / sizeof(contentEncodings[0]); i++) {
+      if (req->getHTTPHeaders()->valueContains(HEADER_ACCEPT_ENCODING, contentEncodings[i][0])) {
+        acceptedEncodings |= (1 << i);
+      }
+    }
+
+    bool notFound;
+    StaticFileCacheEntry * entry = staticFileCache.lookup(reqFile, acceptedEncodings, notFound);
+    if (entry != NULL) {
+      sendCachedFile(req, res, entry);
+      return;
+    }
+    if (notFound) {
+      sendStaticFileNotFound(res);
+      return;
+    }
+
     // Try to open the file
     std::string filename = std::string(DIR_PUBLIC) + reqFile;
 
+    // Look for a precompressed variant that the client accepts. If there is any variant, the
+    // response depends on Accept-Encoding, which caches have to know about.
+    struct stat st;
+    StaticFileInfo info;
+    for(size_t i = 0; i < sizeof(contentEncodings) / sizeof(contentEncodings[0]) && info.encoding == NULL; i++) {
+      std::string variant = filename + contentEncodings[i][1];
+      if (statLittleFS(variant, st)) {
+        info.hasVariants = true;
+        if (acceptedEncodings & (1 << i)) {
+          info.encoding = contentEncodings[i][0];
+          filename = variant;
+        }
+      }
+    }
+
     // Check if the file exists
-    if (!LittleFS.exists(filename.c_str())) {
-      // Send "404 Not Found" as response, as the file doesn't seem to exist
-      res->setStatusCode(404);
-      res->setStatusText("Not found");
-      res->println("404 Not Found");
+    if (info.encoding == NULL && !statLittleFS(filename, st)) {
+      // Send "404 Not Found" as response, as the file doesn't seem to exist (or only in an encoding
+      // that the client does not accept)
+      staticFileCache.insertNotFound(reqFile, acceptedEncodings);
+      sendStaticFileNotFound(res);
       return;
     }
 
-    File file = LittleFS.open(filename.c_str());
-
-    // Set length
-    res->setHeader("Content-Length", httpsserver::intToString(file.size()));
+    // The Content-Type is based on the requested name, so it stays the same for the compressed
+    // variants. Each variant has its own ETag, as its content differs.
+    info.contentType = getContentType(reqFile);
+    info.cacheControl = getCacheControl(reqFile);
+    if (st.st_mtime >= MIN_VALID_MTIME) {
+      struct tm mtime;
+      strftime(info.lastModified, sizeof(info.lastModified), "%a, %d %b %Y %H:%M:%S GMT", gmtime_r(&st.st_mtime, &mtime));
+    }
 
-    // Content-Type is guessed using the definition of the contentTypes-table defined above
-    int cTypeIdx = 0;
-    do {
-      if(reqFile.rfind(contentTypes[cTypeIdx][0])!=std::string::npos) {
-        res->setHeader("Content-Type", contentTypes[cTypeIdx][1]);
-        break;
+    // The ETag is the same whether the file is served from the cache or from LittleFS, so a client
+    // keeps its validator if the file does not fit into the cache
+    info.etag = getStaticFileETag(filename, st);
+
+    // Small files are read into the cache at once
+    if ((size_t)st.st_size <= staticFileCache.getMaxFileSize()) {
+      File file = LittleFS.open(filename.c_str());
+      entry = file ? staticFileCache.insert(reqFile, acceptedEncodings, info, file) : NULL;
+      file.close();
+      if (entry != NULL) {
+        sendCachedFile(req, res, entry);
+        return;
       }
-      cTypeIdx+=1;
-    } while(strlen(contentTypes[cTypeIdx][0])>0);
-
-    // Read the file and write it to the response
-    uint8_t buffer[256];
-    size_t length = 0;
-    do {
-      length = file.read(buffer, 256);
-      res->write(buffer, length);
-    } while (length > 0);
+    }
+
+    if (sendStaticFileHeaders(req, res, info)) {
+      // The body is not sent, so the file does not need to be opened
+      return;
+    }
+
+    File file = LittleFS.open(filename.c_str());
+    sendFileBody(req, res, file, info.etag.c_str(), info.lastModified);
     file.close();
 
   } else {
@@ -609,38 +901,12 @@ void saveHistory(uint32_t userCode, uint8_t state, uint32_t epochtime) {
    */
 void handleGetHistory(HTTPRequest * req, HTTPResponse * res) {
     // Lấy tham số start, end
-    std::string reqStr = req->getRequestString();// Lấy chuỗi yêu cầu từ HTTPRequest
-    std::string query;// Biến để lưu phần query string
-    size_t qpos = reqStr.find('?');// Tìm vị trí dấu hỏi trong chuỗi yêu cầu
-
-    // Nếu có dấu hỏi, lấy phần sau dấu hỏi làm query
-    if (qpos != std::string::npos) {
-      query = reqStr.substr(qpos + 1);// Lấy phần sau dấu hỏi
-    } else {
-      query = "";
-    }
-
     // Mặc định start = 0, end = 0xFFFFFFFF (tức là toàn bộ lịch sử)
     uint32_t start = 0, end = 0xFFFFFFFF;
-    size_t spos = query.find("start=");
-    if (spos != std::string::npos) {// Tìm tham số start trong query
-      // Nếu có, lấy giá trị sau dấu "="
-      size_t st = spos + 6;
-      size_t en = query.find('&', st);
-      std::string param = (en == std::string::npos) ? query.substr(st) : query.substr(st, en - st);
-      start = strtoul(param.c_str(), nullptr, 10);
-    }
-
-    // Tương tự với end
-    // Nếu không có tham số end, mặc định là 0xFFFFFFFF
-    // Nếu có, lấy giá trị từ query
-    size_t epos = query.find("end=");
-    if (epos != std::string::npos) {
-      size_t st = epos + 4;
-      size_t en = query.find('&', st);
-      std::string param = (en == std::string::npos) ? query.substr(st) : query.substr(st, en - st);
-      end = strtoul(param.c_str(), nullptr, 10);
-    }
+    ResourceParameters * params = req->getParams();
+    // Nếu có, lấy giá trị từ query; nếu không, giữ giá trị mặc định
+    params->getQueryParameterUInt("start", start);
+    params->getQueryParameterUInt("end", end);
     
     // In ra log để kiểm tra tham số
     File f = LittleFS.open(HISTORY_FILE, FILE_READ);// Mở file lịch sử 
@@ -674,6 +940,36 @@ void handleGetHistory(HTTPRequest * req, HTTPResponse * res) {
     arr.printTo(*res);
   }
 
+  /**
+   * API: GET /api/history.bin
+   * Sends the raw history file, so that an interrupted download can be resumed with Range.
+   * The file only grows, so its size and modification time identify its version.
+   */
+void handleGetHistoryFile(HTTPRequest * req, HTTPResponse * res) {
+    struct stat st;
+    if (!statLittleFS(HISTORY_FILE, st)) {
+      res->setStatusCode(404);
+      res->setStatusText("Not found");
+      res->println("404 Not Found");
+      return;
+    }
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (unsigned long)st.st_size, (unsigned long)st.st_mtime);
+
+    File f = LittleFS.open(HISTORY_FILE, FILE_READ);
+    if (!f) {
+      res->setStatusCode(500);
+      res->setStatusText("Internal Server Error");
+      res->println("500 Internal Server Error");
+      return;
+    }
+    res->setHeader("Content-Type", "application/octet-stream");
+    res->setHeader("ETag", etag);
+    res->setHeader("Cache-Control", "no-cache");
+    sendFileBody(req, res, f, etag, "");
+    f.close();
+  }
+
 
   //xử lý sự kiện POST tới /api/events bằng cách đọc body JSON và lưu thông tin sự kiện mới
   //client sẽ gửi thông tin về người dùng, trạng thái và thời gian
@@ -685,7 +981,8 @@ void handlePostEvent(HTTPRequest * req, HTTPResponse * res) {
   const size_t capacity = JSON_OBJECT_SIZE(4) + 180;
   DynamicJsonBuffer jsonBuffer(capacity);
 
-  // Create buffer to read request
+  // Create buffer to read request. ArduinoJson parses in place, so this is the only copy of
+  // the body: it is taken directly from the connection's receive buffer.
   char * buffer = new char[capacity + 1];
   memset(buffer, 0, capacity+1);
 
@@ -693,7 +990,14 @@ void handlePostEvent(HTTPRequest * req, HTTPResponse * res) {
   size_t idx = 0;
   // while "not everything read" or "buffer is full"
   while (!req->requestComplete() && idx < capacity) {
-    idx += req->readChars(buffer + idx, capacity-idx);
+    const byte * data;
+    size_t length = req->peekBytes(&data);
+    if (length > capacity - idx) {
+      length = capacity - idx;
+    }
+    memcpy(buffer + idx, data, length);
+    req->consumeBytes(length);
+    idx += length;
   }
 
   // If the request is still not read completely, we cannot process it.
@@ -714,6 +1018,7 @@ void handlePostEvent(HTTPRequest * req, HTTPResponse * res) {
     res->setStatusCode(400);
     res->setStatusText("Bad Request");
     res->println("400 Bad Request: Invalid JSON");
+    delete[] buffer;
     return;
   }
 
@@ -749,6 +1054,9 @@ void handlePostEvent(HTTPRequest * req, HTTPResponse * res) {
   out["epochtime"] = epochtime;
   res->setHeader("Content-Type", "application/json");
   out.printTo(*res);
+
+  // The parsed values point into the buffer, so it can only be freed now
+  delete[] buffer;
 }
 
 /**
@@ -779,16 +1087,94 @@ void handleDeleteEvent(HTTPRequest * req, HTTPResponse * res) {
 size_t readLineFromRequest(HTTPRequest *req, char *buffer, size_t maxLen) {
   size_t i = 0;
   while (i < maxLen - 1) {
-    char c;
-    size_t n = req->readBytes((uint8_t*)&c, 1);
+    // Look at the data in the connection buffer and take everything up to the next \n
+    const byte * data;
+    size_t n = req->peekBytes(&data);
     if (n == 0) break;
-    buffer[i++] = c;
-    if (c == '\n') break;
+    const byte * lineEnd = (const byte *)memchr(data, '\n', n);
+    if (lineEnd != NULL) n = lineEnd - data + 1;
+    if (n > maxLen - 1 - i) n = maxLen - 1 - i;
+    memcpy(buffer + i, data, n);
+    req->consumeBytes(n);
+    i += n;
+    if (buffer[i-1] == '\n') break;
   }
   buffer[i] = 0;
   return i;
 }
 
+/**
+ * Writes the request body to file until the multipart delimiter ("\r\n--boundary") is found.
+ *
+ * The file data is written straight from the connection's receive buffer. Only a delimiter
+ * that might be split across two chunks of the buffer is held back in a small carry buffer.
+ * Returns true if the delimiter has been found. If hash is given, the FNV-1a hash of the data that
+ * has been written is continued in it, and the number of bytes is added to size.
+ */
+bool writeRequestToFile(HTTPRequest *req, File &file, const std::string &delimiter, uint32_t * hash = NULL, size_t * size = NULL) {
+  // Start of the delimiter that has been seen at the end of the previous chunk
+  std::string carry;
+  unsigned long lastDataTS = millis();
+  while (!req->requestComplete()) {
+    const byte * data;
+    size_t n = req->peekBytes(&data);
+    if (n == 0) {
+      // Nothing more arrives once the client is gone
+      if (req->isClientClosed()) return false;
+      // Wait for the next TCP segment, but not forever
+      if (millis() - lastDataTS > HTTPS_CONNECTION_TIMEOUT) return false;
+      req->waitForData(100);
+      continue;
+    }
+    lastDataTS = millis();
+
+    if (!carry.empty()) {
+      size_t cmpLength = std::min(delimiter.size() - carry.size(), n);
+      if (memcmp(data, delimiter.data() + carry.size(), cmpLength) == 0) {
+        carry.append((const char *)data, cmpLength);
+        req->consumeBytes(cmpLength);
+        if (carry.size() == delimiter.size()) return true;
+        continue;
+      }
+      // False alarm. As the delimiter contains \r only at its start, none of the carried
+      // bytes can start another delimiter, so they are file data.
+      file.write((const uint8_t *)carry.data(), carry.size());
+      if (hash != NULL) {
+        *hash = hashStaticFile(*hash, (const uint8_t *)carry.data(), carry.size());
+        *size += carry.size();
+      }
+      carry.clear();
+    }
+
+    // Search for a \r that starts the delimiter (or a part of it, at the end of the chunk)
+    size_t dataLength = n;
+    size_t pos = 0;
+    while (pos < n) {
+      const byte * cr = (const byte *)memchr(data + pos, '\r', n - pos);
+      if (cr == NULL) break;
+      size_t crIdx = cr - data;
+      size_t cmpLength = std::min(delimiter.size(), n - crIdx);
+      if (memcmp(cr, delimiter.data(), cmpLength) == 0) {
+        dataLength = crIdx;
+        carry.assign((const char *)cr, cmpLength);
+        break;
+      }
+      pos = crIdx + 1;
+    }
+
+    if (dataLength > 0) {
+      file.write(data, dataLength);
+      if (hash != NULL) {
+        *hash = hashStaticFile(*hash, data, dataLength);
+        *size += dataLength;
+      }
+    }
+    req->consumeBytes(dataLength + carry.size());
+    if (carry.size() == delimiter.size()) return true;
+  }
+  return false;
+}
+
 /**
  * API endpoint to upload a file to LittleFS via POST /api/upload
  * Expects multipart/form-data with a file field named "file"
@@ -876,28 +1262,19 @@ void handleUploadFile(HTTPRequest * req, HTTPResponse * res) {
     return;
   }
 
-  // Read file data until boundary
-  bool fileDone = false;
-  char buf[256];
-  size_t n;
-  std::string lastLine;
-  while (!fileDone) {
-    n = readLineFromRequest(req, buf, sizeof(buf));
-    if (n == 0) break;
-    std::string s(buf);
-    if (s.find(boundary) != std::string::npos) {
-      fileDone = true;
-      // Remove trailing \r\n from previous line
-      if (!lastLine.empty() && lastLine.back() == '\r') lastLine.pop_back();
-      file.write((const uint8_t*)lastLine.c_str(), lastLine.length());
-      break;
-    }
-    if (!lastLine.empty()) {
-      file.write((const uint8_t*)lastLine.c_str(), lastLine.length());
-    }
-    lastLine = s;
-  }
+  // Write file data until the boundary, directly from the receive buffer. The ETag is hashed on
+  // the way, so the file does not have to be read again when it is served.
+  uint32_t hash = 2166136261u;
+  size_t size = 0;
+  bool complete = writeRequestToFile(req, file, "\r\n" + boundary, &hash, &size);
   file.close();
+  if (complete) {
+    storeStaticFileETag(filepath, size, hash);
+  } else {
+    LittleFS.remove(getStaticFileETagPath(filepath).c_str());
+    staticFileTags.erase(filepath);
+  }
+  staticFileCache.invalidate("/" + filename);
 
   res->setHeader("Content-Type", "application/json");
   res->print((std::string("{\"success\":true,\"filename\":\"") + filename + "\"}").c_str());
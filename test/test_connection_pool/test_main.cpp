@@ -0,0 +1,193 @@
+/**
+ * Heap usage of the connection pool in HTTPServer.
+ *
+ * Opens and closes CLIENT_COUNT connections over the loopback interface and logs the free heap and
+ * the largest free block before and after. The baseline allocates a new HTTPConnection for every
+ * client, as the server did before it kept a pool; the pool has to leave the heap as it found it.
+ *
+ *   pio test -e esp32cam -f test_connection_pool
+ */
+#include <Arduino.h>
+#include <WiFi.h>
+#include <unity.h>
+#include <esp_heap_caps.h>
+
+#include <functional>
+
+#include <HTTPServer.hpp>
+#include <HTTPConnection.hpp>
+#include <HTTPRequest.hpp>
+#include <HTTPResponse.hpp>
+#include <ResourceNode.hpp>
+
+using namespace httpsserver;
+
+#define POOL_PORT 8080
+#define BASELINE_PORT 8081
+#define CLIENT_COUNT 200
+// Time that a single client may take (ms)
+#define CLIENT_TIMEOUT 2000
+// Loss of free heap that is tolerated over all clients, for allocations that lwip keeps
+#define HEAP_TOLERANCE 1024
+
+struct HeapStats {
+  size_t freeBytes;
+  size_t largestBlock;
+};
+
+static HeapStats getHeapStats() {
+  HeapStats stats;
+  stats.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  stats.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  return stats;
+}
+
+static void logHeapStats(const char * name, const HeapStats &before, const HeapStats &after) {
+  Serial.printf("%s, %d clients: free heap %u -> %u bytes, largest free block %u -> %u bytes\n",
+    name, CLIENT_COUNT, before.freeBytes, after.freeBytes, before.largestBlock, after.largestBlock);
+}
+
+static void handleRoot(HTTPRequest * req, HTTPResponse * res) {
+  res->print("Hello");
+}
+
+/**
+ * Connects to the given port on the loopback interface and sends a request
+ */
+static int connectClient(uint16_t port) {
+  int clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (clientSocket < 0) {
+    return -1;
+  }
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(clientSocket, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(clientSocket);
+    return -1;
+  }
+  const char * request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+  send(clientSocket, request, strlen(request), 0);
+  return clientSocket;
+}
+
+/**
+ * Calls serve() until the server has sent the response and closed the connection. Returns false if
+ * that did not happen within CLIENT_TIMEOUT.
+ */
+static bool finishClient(int clientSocket, std::function<void()> serve) {
+  unsigned long start = millis();
+  bool closed = false;
+  char buffer[128];
+  while (!closed && millis() - start < CLIENT_TIMEOUT) {
+    serve();
+    int res = recv(clientSocket, buffer, sizeof(buffer), MSG_DONTWAIT);
+    closed = res == 0 || (res < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+  }
+  close(clientSocket);
+  return closed;
+}
+
+static int openServerSocket(uint16_t port) {
+  int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (serverSocket < 0 || bind(serverSocket, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(serverSocket, 4) != 0) {
+    return -1;
+  }
+  return serverSocket;
+}
+
+/**
+ * Serves a client with a new HTTPConnection, which is deleted afterwards
+ */
+static bool serveWithNewConnection(int serverSocket, ResourceResolver * resolver, HTTPHeaders * defaultHeaders) {
+  int clientSocket = connectClient(BASELINE_PORT);
+  if (clientSocket < 0) {
+    return false;
+  }
+  HTTPConnection * connection = new HTTPConnection(resolver);
+  bool served = connection->initialize(serverSocket, defaultHeaders) >= 0 &&
+    finishClient(clientSocket, [connection]() {
+      if (!connection->isClosed()) {
+        connection->loop();
+      }
+    });
+  delete connection;
+  return served;
+}
+
+static void test_baseline_new_connection_per_client() {
+  ResourceResolver resolver;
+  ResourceNode node("/", "GET", &handleRoot);
+  resolver.registerNode(&node);
+  HTTPHeaders defaultHeaders;
+  int serverSocket = openServerSocket(BASELINE_PORT);
+  TEST_ASSERT_TRUE(serverSocket >= 0);
+
+  // The first client lets lwip allocate what it keeps afterwards
+  TEST_ASSERT_TRUE(serveWithNewConnection(serverSocket, &resolver, &defaultHeaders));
+
+  HeapStats before = getHeapStats();
+  int served = 0;
+  for (int i = 0; i < CLIENT_COUNT; i++) {
+    if (serveWithNewConnection(serverSocket, &resolver, &defaultHeaders)) {
+      served++;
+    }
+  }
+  HeapStats after = getHeapStats();
+  close(serverSocket);
+
+  logHeapStats("Baseline (new HTTPConnection per client)", before, after);
+  TEST_ASSERT_EQUAL(CLIENT_COUNT, served);
+}
+
+static void test_pool_keeps_heap_stable() {
+  HTTPServer server(POOL_PORT, 4, htonl(INADDR_LOOPBACK));
+  ResourceNode node("/", "GET", &handleRoot);
+  server.registerNode(&node);
+  TEST_ASSERT_EQUAL(1, server.start());
+
+  std::function<void()> serve = [&server]() {
+    server.loop();
+  };
+  int clientSocket = connectClient(POOL_PORT);
+  TEST_ASSERT_TRUE(clientSocket >= 0 && finishClient(clientSocket, serve));
+
+  HeapStats before = getHeapStats();
+  int served = 0;
+  for (int i = 0; i < CLIENT_COUNT; i++) {
+    clientSocket = connectClient(POOL_PORT);
+    if (clientSocket >= 0 && finishClient(clientSocket, serve)) {
+      served++;
+    }
+  }
+  HeapStats after = getHeapStats();
+  server.stop();
+
+  logHeapStats("Connection pool", before, after);
+  TEST_ASSERT_EQUAL(CLIENT_COUNT, served);
+  TEST_ASSERT_GREATER_OR_EQUAL(before.freeBytes, after.freeBytes + HEAP_TOLERANCE);
+  TEST_ASSERT_GREATER_OR_EQUAL(before.largestBlock, after.largestBlock + HEAP_TOLERANCE);
+}
+
+void setup() {
+  // Give the serial monitor time to connect
+  delay(2000);
+  Serial.begin(115200);
+  // Starts the TCP/IP stack, the loopback interface does not need a network
+  WiFi.mode(WIFI_STA);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_baseline_new_connection_per_client);
+  RUN_TEST(test_pool_keeps_heap_stable);
+  UNITY_END();
+}
+
+void loop() {
+}
@@ -0,0 +1,154 @@
+/**
+ * Duration of SSL_accept() for a certificate with an RSA 2048 key and one with an ECDSA P-256 key.
+ *
+ * A client task on the other core connects over the loopback interface with WiFiClientSecure. The
+ * server side is set up like HTTPSServer does it, and the time is measured around SSL_accept(). It
+ * includes the time the server waits for the client, which runs in parallel.
+ *
+ *   pio test -e esp32cam -f test_handshake_time
+ */
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <unity.h>
+
+#include <climits>
+
+#include <SSLCert.hpp>
+#include "openssl/ssl.h"
+#undef read
+#include "lwip/sockets.h"
+
+using namespace httpsserver;
+
+// The OpenSSL layer of the esp-idf does not define all key types (see HTTPSServer.cpp)
+#ifndef EVP_PKEY_EC
+#define EVP_PKEY_EC 408
+#endif
+
+#define TEST_PORT 8443
+#define HANDSHAKE_ROUNDS 5
+
+static SemaphoreHandle_t clientDone;
+
+static void clientTask(void *) {
+  for (int i = 0; i < HANDSHAKE_ROUNDS; i++) {
+    WiFiClientSecure client;
+    client.setInsecure();
+    if (client.connect(IPAddress(127, 0, 0, 1), TEST_PORT)) {
+      client.stop();
+    }
+  }
+  xSemaphoreGive(clientDone);
+  vTaskDelete(NULL);
+}
+
+static SSL_CTX * createServerContext(SSLCert &cert) {
+  SSL_CTX * ctx = SSL_CTX_new(TLSv1_2_server_method());
+  if (ctx == NULL) {
+    return NULL;
+  }
+  int res = SSL_CTX_use_certificate_ASN1(ctx, cert.getCertLength(), cert.getCertData());
+  if (res) {
+    if (cert.getPKType() == KEYTYPE_EC) {
+      res = SSL_CTX_use_PrivateKey_ASN1(EVP_PKEY_EC, ctx, cert.getPKData(), cert.getPKLength());
+    } else {
+      res = SSL_CTX_use_RSAPrivateKey_ASN1(ctx, cert.getPKData(), cert.getPKLength());
+    }
+  }
+  if (!res) {
+    SSL_CTX_free(ctx);
+    return NULL;
+  }
+  return ctx;
+}
+
+static int openServerSocket(uint16_t port) {
+  int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (serverSocket < 0 || bind(serverSocket, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(serverSocket, 1) != 0) {
+    return -1;
+  }
+  return serverSocket;
+}
+
+static void measureHandshakes(const char * name, SSLKeySize keySize) {
+  SSLCert cert;
+  unsigned long createStart = millis();
+  TEST_ASSERT_EQUAL(0, createSelfSignedCert(cert, keySize, "CN=localhost,O=Test,C=DE"));
+  Serial.printf("%s: Creating the certificate took %lu ms\n", name, millis() - createStart);
+
+  SSL_CTX * ctx = createServerContext(cert);
+  TEST_ASSERT_NOT_NULL(ctx);
+  int serverSocket = openServerSocket(TEST_PORT);
+  TEST_ASSERT_TRUE(serverSocket >= 0);
+
+  // The test runs on core 1, the client gets core 0
+  TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(clientTask, "tls-client", 8192, NULL, 1, NULL, 0));
+
+  unsigned long total = 0;
+  unsigned long fastest = ULONG_MAX;
+  int handshakes = 0;
+  for (int i = 0; i < HANDSHAKE_ROUNDS; i++) {
+    int clientSocket = accept(serverSocket, NULL, NULL);
+    if (clientSocket < 0) {
+      continue;
+    }
+    SSL * ssl = SSL_new(ctx);
+    if (ssl != NULL && SSL_set_fd(ssl, clientSocket) == 1) {
+      unsigned long start = micros();
+      int res = SSL_accept(ssl);
+      unsigned long duration = micros() - start;
+      if (res == 1) {
+        handshakes++;
+        total += duration;
+        fastest = std::min(fastest, duration);
+        SSL_shutdown(ssl);
+      }
+    }
+    if (ssl != NULL) {
+      SSL_free(ssl);
+    }
+    close(clientSocket);
+  }
+  xSemaphoreTake(clientDone, portMAX_DELAY);
+
+  close(serverSocket);
+  SSL_CTX_free(ctx);
+  cert.clear();
+
+  if (handshakes > 0) {
+    Serial.printf("%s: SSL_accept() took %lu ms on average and %lu ms at best (%d handshakes)\n",
+      name, total / handshakes / 1000, fastest / 1000, handshakes);
+  }
+  TEST_ASSERT_EQUAL(HANDSHAKE_ROUNDS, handshakes);
+}
+
+static void test_handshake_rsa_2048() {
+  measureHandshakes("RSA 2048", KEYSIZE_2048);
+}
+
+static void test_handshake_ecdsa_p256() {
+  measureHandshakes("ECDSA P-256", KEYSIZE_EC_P256);
+}
+
+void setup() {
+  // Give the serial monitor time to connect
+  delay(2000);
+  Serial.begin(115200);
+  // Starts the TCP/IP stack, the loopback interface does not need a network
+  WiFi.mode(WIFI_STA);
+  clientDone = xSemaphoreCreateBinary();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_handshake_rsa_2048);
+  RUN_TEST(test_handshake_ecdsa_p256);
+  UNITY_END();
+}
+
+void loop() {
+}
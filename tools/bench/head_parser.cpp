@@ -0,0 +1,302 @@
+/**
+ * Throughput of the request head parser in HTTPConnection.
+ *
+ * A connection is fed the same request over and over, as a keep-alive client would send it. The
+ * loop() calls that read the request line and the headers are timed separately from the ones that
+ * resolve the route and run the handler, so the parser can be compared on its own. The heap
+ * allocations per request are counted after the first request, which lets the connection allocate
+ * the buffers that it keeps. The "parameter" scenario requests a route with a path parameter.
+ */
+#include <Arduino.h>
+
+#include <HTTPConnection.hpp>
+#include <HTTPHeaders.hpp>
+#include <HTTPRequest.hpp>
+#include <HTTPResponse.hpp>
+#include <ResourceNode.hpp>
+#include <ResourceResolver.hpp>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace httpsserver;
+
+// Each scenario is run for this long
+#define BENCH_DURATION_MS 1000
+
+// Number of calls to operator new
+static size_t allocationCount = 0;
+
+void * operator new(size_t size) {
+  allocationCount++;
+  void * ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == NULL) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void * operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept {
+  free(ptr);
+}
+
+/**
+ * Connection that reads the request from memory instead of the socket. The socket is only needed by
+ * initialize(). Like a client that waits for the response, the next request only becomes available
+ * after nextRequest() has been called: Without Content-Length, everything that follows the head
+ * would be discarded as the body of the request.
+ */
+class BenchConnection : public HTTPConnection {
+public:
+  BenchConnection(ResourceResolver * resolver, const std::string &request):
+    HTTPConnection(resolver),
+    _request(request),
+    _offset(0),
+    _statusLength(0) {
+  }
+
+  bool isParsingHead() {
+    return _connectionState == STATE_INITIAL || _connectionState == STATE_REQUEST_FINISHED;
+  }
+
+  bool isOpen() {
+    return !isClosed() && !isError();
+  }
+
+  void nextRequest() {
+    _offset = 0;
+    _statusLength = 0;
+  }
+
+  // Returns true if the last response started with the given status line
+  bool respondedWith(const char * statusLine) {
+    return _statusLength == strlen(statusLine) && memcmp(_status, statusLine, _statusLength) == 0;
+  }
+
+protected:
+  virtual size_t readBytesToBuffer(byte* buffer, size_t length) {
+    size_t chunk = std::min(length, _request.length() - _offset);
+    memcpy(buffer, _request.data() + _offset, chunk);
+    _offset += chunk;
+    return chunk;
+  }
+
+  virtual bool canReadData() {
+    return _offset < _request.length();
+  }
+
+  virtual size_t writeBytesFromBuffer(byte* buffer, size_t length) {
+    size_t copyLength = std::min(length, sizeof(_status) - _statusLength);
+    memcpy(_status + _statusLength, buffer, copyLength);
+    _statusLength += copyLength;
+    return length;
+  }
+
+private:
+  const std::string _request;
+  size_t _offset;
+  // Beginning of the response, like "HTTP/1.1 200"
+  char _status[12];
+  size_t _statusLength;
+};
+
+static uint32_t handledRequests = 0;
+static size_t handledHeaders = 0;
+
+// The path parameter of the last request. Its memory is reserved in main(), as a handler would
+// usually only look at the parameter instead of copying it
+static std::string handledParameter;
+
+static void handleRequest(HTTPRequest * req, HTTPResponse * res) {
+  handledRequests++;
+  handledHeaders = req->getHTTPHeaders()->size();
+  res->print("ok");
+}
+
+static void handleParameterRequest(HTTPRequest * req, HTTPResponse * res) {
+  req->getParams()->getPathParameter(0, handledParameter);
+  handleRequest(req, res);
+}
+
+static std::string buildRequest(const char * target, const char * firstHeaders, int extraHeaders, size_t extraHeaderLength) {
+  std::string request = std::string("GET ") + target + " HTTP/1.1\r\n";
+  request += firstHeaders;
+  for (int i = 0; i < extraHeaders; i++) {
+    std::string line = "X-Bench-" + std::to_string(i) + ": ";
+    line.append(extraHeaderLength - line.length(), 'a' + (i % 26));
+    request += line + "\r\n";
+  }
+  request += "Connection: keep-alive\r\n\r\n";
+  return request;
+}
+
+/**
+ * The server socket that initialize() accepts the connection from, with a client waiting on it
+ */
+static int openLoopbackSocket(int &clientSocket) {
+  int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrLen = sizeof(addr);
+  if (serverSocket < 0 || bind(serverSocket, (sockaddr*)&addr, addrLen) != 0 || listen(serverSocket, 1) != 0 ||
+      getsockname(serverSocket, (sockaddr*)&addr, &addrLen) != 0) {
+    return -1;
+  }
+  clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (clientSocket < 0 || connect(clientSocket, (sockaddr*)&addr, addrLen) != 0) {
+    return -1;
+  }
+  return serverSocket;
+}
+
+static bool runScenario(const char * name, const std::string &request) {
+  ResourceResolver resolver;
+  ResourceNode node("/bench", "GET", &handleRequest);
+  ResourceNode parameterNode("/bench/sensors/*", "GET", &handleParameterRequest);
+  resolver.registerNode(&node);
+  resolver.registerNode(&parameterNode);
+  HTTPHeaders defaultHeaders;
+
+  int clientSocket = -1;
+  int serverSocket = openLoopbackSocket(clientSocket);
+  BenchConnection connection(&resolver, request);
+  if (serverSocket < 0 || connection.initialize(serverSocket, &defaultHeaders) < 0) {
+    fprintf(stderr, "Could not open a loopback connection\n");
+    return false;
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::duration parseTime = Clock::duration::zero();
+  Clock::time_point start = Clock::now();
+  Clock::time_point end = start + std::chrono::milliseconds(BENCH_DURATION_MS);
+  handledRequests = 0;
+  uint32_t previousRequests = 0;
+  size_t allocationsAfterFirst = 0;
+  while (connection.isOpen()) {
+    bool parsing = connection.isParsingHead();
+    Clock::time_point before = Clock::now();
+    connection.loop();
+    Clock::time_point after = Clock::now();
+    if (parsing) {
+      parseTime += after - before;
+    } else if (handledRequests != previousRequests) {
+      previousRequests = handledRequests;
+      if (handledRequests == 1) {
+        allocationsAfterFirst = allocationCount;
+      }
+      if (after >= end) {
+        break;
+      }
+      connection.nextRequest();
+    } else {
+      fprintf(stderr, "The request has not been handled\n");
+      break;
+    }
+  }
+  Clock::duration totalTime = Clock::now() - start;
+  double allocationsPerRequest = handledRequests > 1 ?
+    (double)(allocationCount - allocationsAfterFirst) / (handledRequests - 1) : 0;
+
+  bool ok = connection.isOpen() && handledRequests > 0;
+  double parseSeconds = std::chrono::duration<double>(parseTime).count();
+  double totalSeconds = std::chrono::duration<double>(totalTime).count();
+  printf("%-10s %6u B head %3u headers  %9.0f heads/s  %7.1f MB/s parsed  %9.0f requests/s  %4.1f allocs/request%s\n",
+    name, (unsigned)request.length(), (unsigned)handledHeaders,
+    handledRequests / parseSeconds, handledRequests * request.length() / parseSeconds / 1e6,
+    handledRequests / totalSeconds, allocationsPerRequest, ok ? "" : "  FAILED");
+
+  connection.closeConnection();
+  close(clientSocket);
+  close(serverSocket);
+  return ok;
+}
+
+/**
+ * Checks that the connection answers the request with the given status line and closes
+ */
+static bool checkRejected(const char * name, const std::string &request, const char * statusLine) {
+  ResourceResolver resolver;
+  ResourceNode node("/bench", "GET", &handleRequest);
+  ResourceNode parameterNode("/bench/sensors/*", "GET", &handleParameterRequest);
+  resolver.registerNode(&node);
+  resolver.registerNode(&parameterNode);
+  HTTPHeaders defaultHeaders;
+
+  int clientSocket = -1;
+  int serverSocket = openLoopbackSocket(clientSocket);
+  BenchConnection connection(&resolver, request);
+  if (serverSocket < 0 || connection.initialize(serverSocket, &defaultHeaders) < 0) {
+    fprintf(stderr, "Could not open a loopback connection\n");
+    return false;
+  }
+
+  handledRequests = 0;
+  for (int i = 0; i < 1000 && connection.isOpen(); i++) {
+    connection.loop();
+  }
+  bool ok = !connection.isOpen() && handledRequests == 0 && connection.respondedWith(statusLine);
+  printf("%-10s %6u B head  rejected with \"%s\"%s\n", name, (unsigned)request.length(), statusLine,
+    ok ? "" : "  FAILED");
+
+  connection.closeConnection();
+  close(clientSocket);
+  close(serverSocket);
+  return ok;
+}
+
+int main() {
+  printf("HTTPS_REQUEST_MAX_HEAD_SIZE = %d\n", (int)HTTPS_REQUEST_MAX_HEAD_SIZE);
+  handledParameter.reserve(64);
+
+  bool ok = runScenario("minimal", buildRequest("/bench?x=1", "Host: esp32.local\r\n", 0, 0));
+  ok &= runScenario("browser", buildRequest("/bench?x=1",
+    "Host: esp32.local\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Referer: https://esp32.local/\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Priority: u=0, i\r\n"
+    "If-None-Match: \"5d41402abc4b2a76\"\r\n", 0, 0));
+  // The parameter is longer than a string without allocated memory can hold
+  ok &= runScenario("parameter", buildRequest("/bench/sensors/living%20room%20temperature?x=1",
+    "Host: esp32.local\r\n", 0, 0));
+  if (handledParameter != "living room temperature") {
+    printf("Wrong path parameter: %s\n", handledParameter.c_str());
+    ok = false;
+  }
+  // As many header lines of the maximum length as fit into the head buffer
+  size_t lineSpace = HTTPS_REQUEST_MAX_HEADER_LENGTH + 2;
+  int largeHeaders = (HTTPS_REQUEST_MAX_HEAD_SIZE - buildRequest("/bench?x=1", "Host: esp32.local\r\n", 0, 0).length()) / lineSpace;
+  largeHeaders = std::min(largeHeaders, HTTPS_REQUEST_MAX_HEADERS - 2);
+  ok &= runScenario("large", buildRequest("/bench?x=1", "Host: esp32.local\r\n", largeHeaders, HTTPS_REQUEST_MAX_HEADER_LENGTH));
+  // One more line does not fit anymore
+  ok &= checkRejected("oversized", buildRequest("/bench?x=1", "Host: esp32.local\r\n", largeHeaders + 1,
+    HTTPS_REQUEST_MAX_HEADER_LENGTH), "HTTP/1.1 431");
+  return ok ? 0 : 1;
+}
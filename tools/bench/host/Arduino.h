@@ -0,0 +1,54 @@
+// Minimal host replacement for the Arduino core, so that the plain HTTP part of the library can be
+// compiled for the benchmarks in tools/bench. Only what the library uses is provided.
+#ifndef BENCH_HOST_ARDUINO_H
+#define BENCH_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define HEX 16
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+// As in the Arduino core, the tag is dropped
+#define ESP_LOGI(tag, ...) do {} while (0)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return write((const uint8_t*)str, strlen(str)); }
+  size_t print(const char *str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value, int base = 10);
+  size_t print(unsigned int value, int base = 10);
+  size_t print(long value, int base = 10);
+  size_t print(unsigned long value, int base = 10);
+  size_t println(const char *str = "");
+  size_t printf(const char *format, ...);
+};
+
+// Discards everything, the benchmarks should not measure logging
+class HardwareSerial : public Print {
+public:
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t size) { return size; }
+};
+
+extern HardwareSerial Serial;
+
+#endif /* BENCH_HOST_ARDUINO_H */
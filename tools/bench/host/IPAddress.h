@@ -0,0 +1,16 @@
+#ifndef BENCH_HOST_IPADDRESS_H
+#define BENCH_HOST_IPADDRESS_H
+
+#include <stdint.h>
+
+class IPAddress {
+public:
+  IPAddress(): _address(0) {}
+  IPAddress(uint32_t address): _address(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d): _address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  operator uint32_t() const { return _address; }
+private:
+  uint32_t _address;
+};
+
+#endif /* BENCH_HOST_IPADDRESS_H */
@@ -0,0 +1,10 @@
+#ifndef BENCH_HOST_ESP32_SHA_H
+#define BENCH_HOST_ESP32_SHA_H
+
+#include <stddef.h>
+
+enum SHA_TYPE { SHA1 };
+
+void esp_sha(SHA_TYPE type, const unsigned char *input, size_t ilen, unsigned char *output);
+
+#endif /* BENCH_HOST_ESP32_SHA_H */
@@ -0,0 +1,80 @@
+#include <Arduino.h>
+#include <esp32/sha.h>
+#include <mbedtls/base64.h>
+
+#include <chrono>
+#include <stdarg.h>
+#include <thread>
+
+HardwareSerial Serial;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (n < size && write(buffer[n])) {
+    n++;
+  }
+  return n;
+}
+
+size_t Print::print(int value, int base) {
+  return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+  return base == 10 ? printf("%ld", value) : printf("%lx", value);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return base == 10 ? printf("%lu", value) : printf("%lx", value);
+}
+
+size_t Print::println(const char *str) {
+  return print(str) + print("\r\n");
+}
+
+size_t Print::printf(const char *format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  return write((const uint8_t*)buffer, std::min((size_t)length, sizeof(buffer) - 1));
+}
+
+// The websocket handshake and basic authentication are not part of the benchmarks
+
+void esp_sha(SHA_TYPE, const unsigned char *, size_t, unsigned char *) {
+  fprintf(stderr, "esp_sha() is not available on the host\n");
+  abort();
+}
+
+int mbedtls_base64_encode(unsigned char *, size_t, size_t *, const unsigned char *, size_t) {
+  fprintf(stderr, "mbedtls_base64_encode() is not available on the host\n");
+  abort();
+}
+
+int mbedtls_base64_decode(unsigned char *, size_t, size_t *, const unsigned char *, size_t) {
+  fprintf(stderr, "mbedtls_base64_decode() is not available on the host\n");
+  abort();
+}
@@ -0,0 +1 @@
+#include <arpa/inet.h>
@@ -0,0 +1,9 @@
+#ifndef BENCH_HOST_MBEDTLS_BASE64_H
+#define BENCH_HOST_MBEDTLS_BASE64_H
+
+#include <stddef.h>
+
+int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen, const unsigned char *src, size_t slen);
+int mbedtls_base64_decode(unsigned char *dst, size_t dlen, size_t *olen, const unsigned char *src, size_t slen);
+
+#endif /* BENCH_HOST_MBEDTLS_BASE64_H */
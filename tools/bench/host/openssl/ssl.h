@@ -0,0 +1,2 @@
+// The benchmarks only use the plain HTTP part of the library, which includes this header but does
+// not use it
@@ -0,0 +1,99 @@
+/**
+ * Cost of ResourceResolver::resolveNode() for 10, 100 and 1000 registered routes.
+ *
+ * Half of the routes are static, the other half end with a path parameter. The URLs that are
+ * resolved match the first and the last registered route, a parameter route, or nothing at all.
+ */
+#include <Arduino.h>
+
+#include <HTTPRequest.hpp>
+#include <HTTPResponse.hpp>
+#include <ResolvedResource.hpp>
+#include <ResourceNode.hpp>
+#include <ResourceResolver.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace httpsserver;
+
+// Number of lookups per URL and route count
+#define BENCH_LOOKUPS 1000000
+
+static void handleRequest(HTTPRequest *, HTTPResponse *) {
+}
+
+static std::string routePath(int i) {
+  std::string path = "/api/device" + std::to_string(i);
+  return (i % 2 == 0) ? path + "/status" : path + "/sensor/*";
+}
+
+/**
+ * Returns the time per lookup in ns, or a negative value if the result was not as expected
+ */
+static double timeLookups(ResourceResolver &resolver, const std::string &url, bool expectMatch) {
+  typedef std::chrono::steady_clock Clock;
+  std::string method = "GET";
+  uint32_t matches = 0;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < BENCH_LOOKUPS; i++) {
+    // A new ResolvedResource for every lookup, as HTTPConnection does
+    ResolvedResource resolved;
+    resolver.resolveNode(method, url, resolved, HANDLER_CALLBACK);
+    if (resolved.didMatch()) {
+      matches++;
+    }
+  }
+  Clock::duration elapsed = Clock::now() - start;
+  if (matches != (expectMatch ? BENCH_LOOKUPS : 0)) {
+    return -1;
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_LOOKUPS;
+}
+
+static bool runScenario(int routeCount) {
+  ResourceResolver resolver;
+  std::vector<ResourceNode*> nodes;
+  for (int i = 0; i < routeCount; i++) {
+    nodes.push_back(new ResourceNode(routePath(i), "GET", &handleRequest));
+    resolver.registerNode(nodes.back());
+  }
+
+  struct {
+    const char * name;
+    std::string url;
+    bool expectMatch;
+  } lookups[] = {
+    { "first", "/api/device0/status", true },
+    { "last", "/api/device" + std::to_string(routeCount - 2) + "/status?verbose=1", true },
+    { "parameter", "/api/device" + std::to_string(routeCount - 1) + "/sensor/42", true },
+    { "miss", "/api/device" + std::to_string(routeCount) + "/status", false },
+  };
+
+  bool ok = true;
+  printf("%5d routes", routeCount);
+  for (size_t i = 0; i < sizeof(lookups) / sizeof(lookups[0]); i++) {
+    double ns = timeLookups(resolver, lookups[i].url, lookups[i].expectMatch);
+    if (ns < 0) {
+      printf("  %s: FAILED", lookups[i].name);
+      ok = false;
+    } else {
+      printf("  %s %6.1f ns", lookups[i].name, ns);
+    }
+  }
+  printf("\n");
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    resolver.unregisterNode(nodes[i]);
+    delete nodes[i];
+  }
+  return ok;
+}
+
+int main() {
+  bool ok = runScenario(10);
+  ok &= runScenario(100);
+  ok &= runScenario(1000);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+"""
+Bundles the files in assets/ into include/assets_bundle.h.
+
+Each file is compressed with gzip and stored as a StaticBlob in PROGMEM, together with the
+prerendered heads of its 200 and 304 responses, so that a StaticBlobNode can send it without
+building any headers at runtime.
+
+The script runs before each build as a PlatformIO pre-script:
+
+    extra_scripts = pre:tools/bundle_assets.py
+
+It can also be run directly with "python3 tools/bundle_assets.py". The header is only rewritten if
+its content changes, so unchanged assets do not trigger a rebuild. Each run prints the raw and the
+compressed size of every asset, which are also noted in the header.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=UTF-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+}
+
+# The pages are part of the firmware, so browsers have to revalidate them after an update
+CACHE_CONTROL = "no-cache"
+
+
+def c_identifier(filename):
+    return "ASSET_" + re.sub(r"[^A-Za-z0-9]", "_", filename).upper()
+
+
+def c_string(lines):
+    """Renders the lines of a head as a C string literal, one line per row"""
+    rows = []
+    for line in lines:
+        escaped = line.replace("\\", "\\\\").replace("\"", "\\\"")
+        rows.append("  \"%s\\r\\n\"" % escaped)
+    return "\n".join(rows)
+
+
+def c_bytes(data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(rows)
+
+
+def size_report(filename, raw_size, gzip_size):
+    return "%s: %d bytes, %d bytes with gzip (%d%%)" % (
+        filename, raw_size, gzip_size, round(100.0 * gzip_size / max(raw_size, 1)))
+
+
+def render_asset(filename, content, body):
+    name = c_identifier(filename)
+    extension = os.path.splitext(filename)[1].lower()
+    content_type = CONTENT_TYPES.get(extension, "application/octet-stream")
+    etag = "\"%s\"" % hashlib.sha256(body).hexdigest()[:16]
+
+    head = [
+        "HTTP/1.1 200 OK",
+        "Content-Type: " + content_type,
+        "Content-Encoding: gzip",
+        "Content-Length: %d" % len(body),
+        "ETag: " + etag,
+        "Cache-Control: " + CACHE_CONTROL,
+        "Vary: Accept-Encoding",
+    ]
+    not_modified_head = [
+        "HTTP/1.1 304 Not Modified",
+        "ETag: " + etag,
+        "Cache-Control: " + CACHE_CONTROL,
+        "Vary: Accept-Encoding",
+    ]
+
+    return "\n".join([
+        "// " + size_report(filename, len(content), len(body)),
+        "const char %s_HEAD[] PROGMEM =\n%s;" % (name, c_string(head)),
+        "const char %s_NOT_MODIFIED_HEAD[] PROGMEM =\n%s;" % (name, c_string(not_modified_head)),
+        "const uint8_t %s_BODY[] PROGMEM = {\n%s\n};" % (name, c_bytes(body)),
+        "const httpsserver::StaticBlob %s = {" % name,
+        "  %s_HEAD, sizeof(%s_HEAD) - 1," % (name, name),
+        "  %s_NOT_MODIFIED_HEAD, sizeof(%s_NOT_MODIFIED_HEAD) - 1," % (name, name),
+        "  %s_BODY, sizeof(%s_BODY)," % (name, name),
+        "  \"%s\"," % etag.replace("\"", "\\\""),
+        "  \"gzip\"",
+        "};",
+        "",
+    ])
+
+
+def bundle(project_dir):
+    assets_dir = os.path.join(project_dir, "assets")
+    output = os.path.join(project_dir, "include", "assets_bundle.h")
+
+    parts = [
+        "// Generated by tools/bundle_assets.py from the files in assets/. Do not edit.",
+        "#ifndef ASSETS_BUNDLE_H",
+        "#define ASSETS_BUNDLE_H",
+        "",
+        "#include <Arduino.h>",
+        "#include <StaticBlobNode.hpp>",
+        "",
+    ]
+    raw_total = 0
+    gzip_total = 0
+    for filename in sorted(os.listdir(assets_dir)):
+        path = os.path.join(assets_dir, filename)
+        if os.path.isfile(path):
+            with open(path, "rb") as f:
+                content = f.read()
+            # mtime=0 keeps the output identical for identical input
+            body = gzip.compress(content, compresslevel=9, mtime=0)
+            parts.append(render_asset(filename, content, body))
+            print("Asset " + size_report(filename, len(content), len(body)))
+            raw_total += len(content)
+            gzip_total += len(body)
+    print("Assets " + size_report("total", raw_total, gzip_total))
+    parts.append("#endif /* ASSETS_BUNDLE_H */")
+    parts.append("")
+    text = "\n".join(parts)
+
+    if os.path.exists(output):
+        with open(output, "r") as f:
+            if f.read() == text:
+                return
+    with open(output, "w") as f:
+        f.write(text)
+    print("Bundled assets into " + output)
+
+
+try:
+    Import("env")  # noqa: F821 (provided by SCons)
+    bundle(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    bundle(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))